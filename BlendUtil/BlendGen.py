@@ -23,16 +23,50 @@ from collections import namedtuple
 class P:
     def __init__(self):
         self.l = []
+        self.n = 0
+        # Container format of the sections written with mkSect (See mkDatHeader)
+        self.version = 1
 
     def append(self, s):
         self.l.append(s)
+        self.n += len(s)
 
     def merge(self, otherP):
         self.l.extend(otherP.l)
+        self.n += otherP.n
 
     def getBytes(self):
         return b"".join(self.l)
 
+    def size(self):
+        return self.n
+
+# .dat v2 (See BU_DAT_MAGIC in Source.cpp): 16 byte file header, 16 byte aligned section payloads, per-section CRC32C
+DAT_MAGIC   = b"BUDT"
+DAT_VERSION = 2
+DAT_ALIGN   = 16
+
+def datAlign(n):
+    return (n + DAT_ALIGN - 1) & ~(DAT_ALIGN - 1)
+
+def mkCrc32cTable():
+    t = []
+    for i in range(256):
+        c = i
+        for k in range(8):
+            c = (c >> 1) ^ (0x82F63B78 if c & 1 else 0)
+        t.append(c)
+    return t
+
+CRC32C_TABLE = mkCrc32cTable()
+
+def crc32c(data, crc=0):
+    t = CRC32C_TABLE
+    crc ^= 0xFFFFFFFF
+    for b in data:
+        crc = t[(crc ^ b) & 0xFF] ^ (crc >> 8)
+    return crc ^ 0xFFFFFFFF
+
 def mkInt32(p, i):
     assert isinstance(i, int)
     p.append(sPack('<i', i))
@@ -48,9 +82,49 @@ def mkMatrix4x4(p, m):
 def mkLendel(p, data):
     p.append(sPack('<i%ds' % (len(data)), len(data), data))
 
-def mkSect(p, name, data):
-    p.append(sPack('<iii%ds%ds' % (len(name), len(data)),
-        4+4+4+len(name)+len(data), len(name), len(data), name, data))
+def mkDatHeader(p):
+    """Makes p a v2 file. Must come before any section."""
+    assert p.size() == 0
+    p.append(sPack('<4siii', DAT_MAGIC, DAT_VERSION, 16, 0))
+    p.version = DAT_VERSION
+
+def mkSect(p, name, data, padTail=True):
+    if p.version == 1:
+        p.append(sPack('<iii%ds%ds' % (len(name), len(data)),
+            4+4+4+len(name)+len(data), len(name), len(data), name, data))
+        return
+    assert p.size() % DAT_ALIGN == 0
+    lenUsed  = 4+4+4+4+datAlign(len(name))+len(data)
+    lenTotal = datAlign(lenUsed) if padTail else lenUsed
+    crc = crc32c(data, crc32c(name))
+    p.append(sPack('<iiiI', lenTotal, len(name), len(data), crc))
+    p.append(name + bytes(datAlign(len(name)) - len(name)))
+    p.append(data + bytes(lenTotal - lenUsed))
+
+def mkSectToc(p):
+    """Trailing table of contents: [LenDel name, int offset]* plus the lenTotal of the TOC section itself,
+       so that a reader can locate it from the end of the file.
+       Offsets are from the start of the file. Must be the last section written
+       (In v2 it is written without trailing padding so the lenTotal stays the last int of the file)."""
+    b = p.getBytes()
+    lNameOff = []
+    lenHeader = 4+4+4 if p.version == 1 else 4+4+4+4
+    off = 0 if p.version == 1 else 16
+    while off < len(b):
+        lenTotal, lenName, lenData = sUnpack('<iii', b[off:off+12])
+        lAppendI(lNameOff, (b[off+lenHeader:off+lenHeader+lenName], off))
+        off += lenTotal
+    assert off == len(b)
+    
+    name = b"SECTIONTOC"
+    pW = P()
+    for n, o in lNameOff:
+        mkLendel(pW, n)
+        mkInt32(pW, o)
+    lenName = len(name) if p.version == 1 else datAlign(len(name))
+    lenTotal = lenHeader+lenName+len(pW.getBytes())+4
+    mkInt32(pW, lenTotal)
+    mkSect(p, name, pW.getBytes(), padTail=False)
 
 def mkLenDelSec(p, bSecName, lStr):
     pW = P()
@@ -103,6 +177,103 @@ def mkMatrixSec(p, bSecName, lMtx):
         mkMatrix4x4(pW, n)
     mkSect(p, bSecName, pW.getBytes())
 
+# Animation channel compression (See mkAnimChanPackSec)
+ANIM_TOL_LOC   = 0.0001
+ANIM_TOL_ROT   = 0.001
+ANIM_TOL_SCALE = 0.0001
+
+def animQuatNlerp(a, b, f):
+    sign = -1.0 if sum([x*y for x, y in zip(a, b)]) < 0.0 else 1.0
+    q = [x + (sign*y - x) * f for x, y in zip(a, b)]
+    n = sum([x*x for x in q]) ** 0.5
+    return [x / n for x in q]
+
+def animVecLerp(a, b, f):
+    return [x + (y - x) * f for x, y in zip(a, b)]
+
+def animQuatErr(a, b):
+    return min(max([abs(x - y) for x, y in zip(a, b)]), max([abs(x + y) for x, y in zip(a, b)]))
+
+def animVecErr(a, b):
+    return max([abs(x - y) for x, y in zip(a, b)])
+
+def animReduceLinear(lTime, lVal, fLerp, fErr, tol):
+    """Indices of the keys kept so that interpolating between kept keys stays within 'tol' of every input key.
+       Greedy: each segment is extended while all the keys it skips stay within the bound."""
+    n = len(lTime)
+    lKeep = [0]
+    beg = 0
+    while beg < n - 1:
+        end = beg + 1
+        while end + 1 < n:
+            cand = end + 1
+            span = lTime[cand] - lTime[beg]
+            if not all([fErr(fLerp(lVal[beg], lVal[cand], (lTime[i] - lTime[beg]) / span), lVal[i]) <= tol for i in range(beg + 1, cand)]):
+                break
+            end = cand
+        lAppendI(lKeep, end)
+        beg = end
+    return lKeep
+
+def animQuatPackSmallest3(q):
+    """48 bits: index of the largest component (2), the other three (15 each, in [-1/sqrt(2), 1/sqrt(2)]), one zero bit.
+       The largest component is made positive and dropped."""
+    idx = max(range(4), key=lambda i: abs(q[i]))
+    if q[idx] < 0.0:
+        q = [-x for x in q]
+    lim = 0.5 ** 0.5
+    lQ = [int(round((min(max(q[i], -lim), lim) / lim * 0.5 + 0.5) * 32767.0)) for i in range(4) if i != idx]
+    bits = (idx << 46) | (lQ[0] << 31) | (lQ[1] << 16) | (lQ[2] << 1)
+    return sPack('<Q', bits)[:6]
+
+def mkAnimChanPack(p, lTime, lTrs, tolLoc, tolRot, tolScale):
+    """Per track (location, rotation, scale):
+         int numKey     0: track equals the identity default, 1: constant, n: keys after linear reduction
+         float time*    only when numKey > 1
+         value*         location/scale 3 floats, rotation 6 bytes smallest-three"""
+    n = len(lTime)
+    lLoc   = [lTrs[10*k+0:10*k+3]  for k in range(n)]
+    lRot   = [lTrs[10*k+3:10*k+7]  for k in range(n)]
+    lScale = [lTrs[10*k+7:10*k+10] for k in range(n)]
+    # Hemisphere continuity, so that neighbouring keys interpolate the short way
+    for k in range(1, n):
+        if sum([x*y for x, y in zip(lRot[k-1], lRot[k])]) < 0.0:
+            lRot[k] = [-x for x in lRot[k]]
+    
+    def mkTrack(lVal, default, fLerp, fErr, tol, fVal):
+        if all([fErr(v, default) <= tol for v in lVal]):
+            mkInt32(p, 0)
+            return
+        if all([fErr(v, lVal[0]) <= tol for v in lVal]):
+            mkInt32(p, 1)
+            fVal(lVal[0])
+            return
+        lKeep = animReduceLinear(lTime, lVal, fLerp, fErr, tol)
+        mkInt32(p, len(lKeep))
+        for k in lKeep:
+            mkFloat(p, lTime[k])
+        for k in lKeep:
+            fVal(lVal[k])
+    
+    def mkVec3(v):
+        for x in v:
+            mkFloat(p, float(x))
+    def mkQuat(q):
+        p.append(animQuatPackSmallest3(q))
+    
+    mkTrack(lLoc,   [0.0, 0.0, 0.0],      animVecLerp,   animVecErr,  tolLoc,   mkVec3)
+    mkTrack(lRot,   [0.0, 0.0, 0.0, 1.0], animQuatNlerp, animQuatErr, tolRot,   mkQuat)
+    mkTrack(lScale, [1.0, 1.0, 1.0],      animVecLerp,   animVecErr,  tolScale, mkVec3)
+
+def mkAnimChanPackSec(p, bSecName, llTime, llTrs, tolLoc=ANIM_TOL_LOC, tolRot=ANIM_TOL_ROT, tolScale=ANIM_TOL_SCALE):
+    """Compressed counterpart of the ANIMCHANTIME + ANIMCHANTRS pair: per channel a LenDel of mkAnimChanPack"""
+    pW = P()
+    for lTime, lTrs in zip(llTime, llTrs):
+        pX = P()
+        mkAnimChanPack(pX, lTime, lTrs, tolLoc, tolRot, tolScale)
+        mkLendel(pW, pX.getBytes())
+    mkSect(p, bSecName, pW.getBytes())
+
 def run():
     p = P()
 
@@ -480,6 +651,7 @@ def Br3():
     def QueryL_tlBA_idA(idA): return GenQueryCompositeL_tbl_lAttr_lVal(tlBA, ['idA'], [idA])
     def Query_tlBA_idB(idB): return GenQueryComposite_tbl_lAttr_lVal(tlBA, ['idB'], [idB])
     def Query_tAnim_Anim(anim): return GenQueryComposite_tbl_lAttr_lVal(tAnim, ['Anim'], [anim])
+    def Query_tAnim_id(id): return GenQuery_tbl_attr_val(tAnim, 'id', id)
         
     def tUniq(tbl, attrPlus):
         lAttr = attrPlus if isinstance(attrPlus, list) else [attrPlus]
@@ -540,17 +712,19 @@ def Br3():
     assert len(oAct) == 1
     assert len(oArm) == 1
     
+    def GetDataPathElt(blenderDataPath):
+        import re
+        rq = re.search(r"""(?P<prefix>pose\.bones)
+                          \["(?P<name>(\w|\s|\.)+)"\]
+                          \.(?P<tag>\w+)""", blenderDataPath, re.VERBOSE)
+        assert rq # FIXME: P<name> part format: Currently accepts chars, spaces and dots.
+        r = rq.groupdict()
+        assert len(r['name']) and r['tag'] in ['location', 'rotation_quaternion', 'scale']
+        return r
+    def GetDataPathEltName(blenderDataPath):
+        return GetDataPathElt(blenderDataPath)['name']
+    
     def GetAnimByMatchName(oAct):
-        def GetDataPathEltName(blenderDataPath):
-            import re
-            rq = re.search(r"""(?P<prefix>pose\.bones)
-                              \["(?P<name>(\w|\s|\.)+)"\]
-                              \.(?P<tag>\w+)""", blenderDataPath, re.VERBOSE)
-            assert rq # FIXME: P<name> part format: Currently accepts chars, spaces and dots.
-            r = rq.groupdict()
-            assert len(r['name']) and r['tag'] in ['location', 'rotation_quaternion', 'scale']
-            return r['name']
-        
         ActInflu = namedtuple('ActInflu', ['animName', 'armName', 'lChanName'])
         ret = []
         for act in oAct:
@@ -573,6 +747,37 @@ def Br3():
     tAnim = [TuptAnim(i, m.animName) for i, m in enumerate(lUniq(allAnim, f=lambda x: x.animName))]
     tlAnimArmChan = [TuptlAnimArmChan(Query_tAnim_Anim(m.animName).id, Query_tA_A(m.armName).id, Query_tB_AB([m.armName, c]).id) for m in allAnim for c in m.lChanName]
     
+    # GetAnimByMatchName output is in oAct order
+    dActByAnimArm = dict(((m.animName, m.armName), act) for act, m in zip(oAct, allAnim))
+    
+    def GetAnimChanKeys(act, chanName):
+        """Samples the channel's fcurves at every frame of their keyed range.
+           Returns ([time]*, [tx ty tz qx qy qz qw sx sy sz]*) flat, times in seconds.
+           Missing fcurves take the pose bone defaults (zero location, identity rotation, unit scale)."""
+        lFc = [fc for fc in act.fcurves if GetDataPathEltName(fc.data_path) == chanName]
+        lKeyFrame = [kp.co[0] for fc in lFc for kp in fc.keyframe_points]
+        # Every frame between the first and last key, so that curve shapes survive; mkAnimChanPackSec drops the redundant ones
+        lFrame = sorted(set(lKeyFrame + [float(f) for f in range(int(min(lKeyFrame)), int(max(lKeyFrame)) + 1)]))
+        assert len(lFrame)
+        def Eval(tag, idx, default):
+            lTagFc = [fc for fc in lFc if GetDataPathElt(fc.data_path)['tag'] == tag and fc.array_index == idx]
+            return [float(lTagFc[0].evaluate(f)) if lTagFc else default for f in lFrame]
+        loc = [Eval('location', i, 0.0) for i in range(3)]
+        rot = [Eval('rotation_quaternion', i, 1.0 if i == 0 else 0.0) for i in range(4)]  # Blender order w x y z
+        scl = [Eval('scale', i, 1.0) for i in range(3)]
+        fps = float(bpy.context.scene.render.fps)
+        lTime = [float(f) / fps for f in lFrame]
+        lTrs = []
+        for k in range(len(lFrame)):
+            w, x, y, z = [rot[i][k] for i in range(4)]
+            n = (w*w + x*x + y*y + z*z) ** 0.5
+            lTrs.extend([loc[0][k], loc[1][k], loc[2][k], x/n, y/n, z/n, w/n, scl[0][k], scl[1][k], scl[2][k]])
+        return lTime, lTrs
+    
+    animName = [m.Anim for m in tinorder(tAnim, 'id')]
+    animChan = GenSortComposite_tbl_lAttr(tlAnimArmChan, ['idAnim', 'idB'])
+    animChanKeys = [GetAnimChanKeys(dActByAnimArm[(Query_tAnim_id(m.idAnim).Anim, Query_tA_id(m.idA).A)], Query_tB_id(m.idB).B) for m in animChan]
+    
     # FIXME: Blender global side effect
 #    for t in tinorder(tA, 'id'):
 #        assert t.oA.pose_position == 'REST'
@@ -582,6 +787,7 @@ def Br3():
     ######
     
     p = P()
+    mkDatHeader(p)
 
     mkLenDelSec(p, b"MESHNAME", [BytesFromStr(i) for i in meshName])
     mkIntSec(p, b"MESHPARENT", meshParent)
@@ -590,11 +796,18 @@ def Br3():
     mkLenDelSec(p, b"BONENAME", [BytesFromStr(i) for i in boneName])
     mkIntSec(p, b"BONEPARENT", boneParent)
     mkMatrixSec(p, b"BONEMATRIX", [BlendMatToList(m) for m in boneMatrix])
+    mkMatrixSec(p, b"BONEINVBIND", [BlendMatToList(m.inverted()) for m in boneMatrix])
     
     mkListFloatSec(p, b"MESHVERT", meshVert)
     mkListIntSec(p, b"MESHINDEX", meshIndex)
     mkListListPairIntFloatSec(p, b"MESHVERTBONEWEIGHT", meshVertBoneWeight)
     
+    mkLenDelSec(p, b"ANIMNAME", [BytesFromStr(i) for i in animName])
+    mkIntSec(p, b"ANIMCHAN", lFlatten([[m.idAnim, m.idB] for m in animChan]))
+    mkAnimChanPackSec(p, b"ANIMCHANPACK", [k[0] for k in animChanKeys], [k[1] for k in animChanKeys])
+    
+    mkSectToc(p)
+    
     return p
         
 def BlendRun():
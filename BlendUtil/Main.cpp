@@ -1,8 +1,58 @@
 #include <cstdlib>
+#include <cstring>
+#include <string>
 
 void BlendUtilRun(void);
+void BlendUtilRunBatch(const std::string &dir, int numThread);
+void BlendUtilRunBake(const std::string &fIn, const std::string &fOut, bool optimize);
+void BlendUtilRunOptMesh(const std::string &fName);
+void BlendUtilBenchVertWeight(int numVert);
+void BlendUtilBenchMat(int numMat);
+void BlendUtilBenchSkin(int numVert, int numThread);
+void BlendUtilBenchPose(int numChar, int numThread);
+void BlendUtilBenchAnim(int numBone, int numFrame);
 
 int main(int argc, char **argv) {
+	if (argc >= 3 && strcmp(argv[1], "batch") == 0) {
+		BlendUtilRunBatch(argv[2], argc >= 4 ? atoi(argv[3]) : 0);
+		return EXIT_SUCCESS;
+	}
+
+	if (argc >= 4 && strcmp(argv[1], "bake") == 0) {
+		BlendUtilRunBake(argv[2], argv[3], argc >= 5 && strcmp(argv[4], "optimize") == 0);
+		return EXIT_SUCCESS;
+	}
+
+	if (argc >= 3 && strcmp(argv[1], "optmesh") == 0) {
+		BlendUtilRunOptMesh(argv[2]);
+		return EXIT_SUCCESS;
+	}
+
+	if (argc >= 2 && strcmp(argv[1], "benchvertweight") == 0) {
+		BlendUtilBenchVertWeight(argc >= 3 ? atoi(argv[2]) : 1000000);
+		return EXIT_SUCCESS;
+	}
+
+	if (argc >= 2 && strcmp(argv[1], "benchmat") == 0) {
+		BlendUtilBenchMat(argc >= 3 ? atoi(argv[2]) : 16384);
+		return EXIT_SUCCESS;
+	}
+
+	if (argc >= 2 && strcmp(argv[1], "benchskin") == 0) {
+		BlendUtilBenchSkin(argc >= 3 ? atoi(argv[2]) : 1000000, argc >= 4 ? atoi(argv[3]) : 0);
+		return EXIT_SUCCESS;
+	}
+
+	if (argc >= 2 && strcmp(argv[1], "benchpose") == 0) {
+		BlendUtilBenchPose(argc >= 3 ? atoi(argv[2]) : 1000, argc >= 4 ? atoi(argv[3]) : 0);
+		return EXIT_SUCCESS;
+	}
+
+	if (argc >= 2 && strcmp(argv[1], "benchanim") == 0) {
+		BlendUtilBenchAnim(argc >= 3 ? atoi(argv[2]) : 64, argc >= 4 ? atoi(argv[3]) : 120);
+		return EXIT_SUCCESS;
+	}
+
 	BlendUtilRun();
 	return EXIT_SUCCESS;
 }
@@ -4,17 +4,63 @@
 /* SCNd32 is 2013 only, thanks MSVC */
 /* #include <inttypes.h> */
 #include <cstdint>
+#include <climits> /* INT_MAX */
 #include <cctype> /* isspace */
+#include <cmath> /* fabsf */
+#include <cfloat> /* FLT_MAX */
 
 #include <memory>
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <algorithm>
 #include <numeric> /* ::std::accumulate */
 #include <functional> /* ::std::function */
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
 
 #include <exception>
+#include <typeinfo>
+
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  define NOMINMAX
+#  include <windows.h>
+#  include <malloc.h> /* _aligned_malloc */
+#else
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <dirent.h>
+#endif
+
+/* SSE2 is baseline on x64 and the VS2012 x86 default (/arch:SSE2).
+*  AVX2/FMA kernels (and the SSE4.2 CRC32C) are compiled per-function and only called after a runtime CPU check (See DMatKernelSelect). */
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#  define BU_DMAT_SSE2
+#  include <emmintrin.h>
+#  if defined(_MSC_VER)
+#    define BU_DMAT_AVX2
+#    define BU_TARGET_AVX2
+#    define BU_CRC32C_SSE42
+#    define BU_TARGET_SSE42
+#    include <immintrin.h>
+#    include <intrin.h> /* __cpuid */
+#  elif defined(__GNUC__)
+#    define BU_DMAT_AVX2
+#    define BU_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#    define BU_CRC32C_SSE42
+#    define BU_TARGET_SSE42 __attribute__((target("sse4.2")))
+#    include <immintrin.h>
+#    include <cpuid.h>
+#  endif
+#endif
 
 /* warning C4018: signed/unsigned mismatch; warning C4996: fopen deprecated */
 #pragma warning(disable : 4018 4996)
@@ -25,9 +71,13 @@ using namespace std;
 #define BU_MAX_TOTAL_BONE_PER_MESH 64
 
 class ExcItemExist  : public exception {};
-class ExcRecurseMax : public exception {};
+class ExcFileOpen   : public exception {};
+/* .dat v2 integrity (See Parse::ReadDatVersion) */
+class ExcChecksum   : public exception {};
+class ExcVersion    : public exception {};
 
 class slice_str_t {};
+class slice_mmap_t {};
 class slice_reslice_abs_t {};
 class slice_reslice_rel_t {};
 
@@ -66,6 +116,26 @@ struct DMat {
 	}
 
 	static DMat Transpose(const DMat &a) {
+#ifdef BU_DMAT_SSE2
+		return TransposeSse2(a);
+#else
+		return TransposeScalar(a);
+#endif
+	}
+
+	static DMat Multiply(const DMat &lhs, const DMat &rhs) {
+#ifdef BU_DMAT_SSE2
+		return MultiplySse2(lhs, rhs);
+#else
+		return MultiplyScalar(lhs, rhs);
+#endif
+	}
+
+	/* oM[i] = lhs[i] * rhs[i] for i in [0, n); oM may alias lhs or rhs element-for-element.
+	*  Dispatches to the widest kernel the CPU supports. */
+	static void MultiplyMany(const DMat *lhs, const DMat *rhs, DMat *oM, int n);
+
+	static DMat TransposeScalar(const DMat &a) {
 		DMat m;
 		for (int i = 0; i < 4; i++)
 			for (int j = 0; j < 4; j++)
@@ -73,7 +143,7 @@ struct DMat {
 		return m;
 	}
 
-	static DMat Multiply(const DMat &lhs, const DMat &rhs) {
+	static DMat MultiplyScalar(const DMat &lhs, const DMat &rhs) {
 		DMat m;
 		for (int r = 0; r < 4; r++)
 			for (int c = 0; c < 4; c++) {
@@ -86,13 +156,122 @@ struct DMat {
 			return m;
 	}
 
+#ifdef BU_DMAT_SSE2
+	static DMat TransposeSse2(const DMat &a) {
+		__m128 c0 = _mm_loadu_ps(a.d + 0);
+		__m128 c1 = _mm_loadu_ps(a.d + 4);
+		__m128 c2 = _mm_loadu_ps(a.d + 8);
+		__m128 c3 = _mm_loadu_ps(a.d + 12);
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+		DMat m;
+		_mm_storeu_ps(m.d + 0, c0);
+		_mm_storeu_ps(m.d + 4, c1);
+		_mm_storeu_ps(m.d + 8, c2);
+		_mm_storeu_ps(m.d + 12, c3);
+		return m;
+	}
+
+	/* Column c of the result is the sum over k of (column k of lhs) * rhs(k,c).
+	*  Same operation order as MultiplyScalar (no FMA), so results are identical. */
+	static DMat MultiplySse2(const DMat &lhs, const DMat &rhs) {
+		__m128 l0 = _mm_loadu_ps(lhs.d + 0);
+		__m128 l1 = _mm_loadu_ps(lhs.d + 4);
+		__m128 l2 = _mm_loadu_ps(lhs.d + 8);
+		__m128 l3 = _mm_loadu_ps(lhs.d + 12);
+		DMat m;
+		for (int c = 0; c < 4; c++) {
+			const float *r = rhs.d + 4 * c;
+			__m128 v = _mm_mul_ps(l0, _mm_set1_ps(r[0]));
+			v = _mm_add_ps(v, _mm_mul_ps(l1, _mm_set1_ps(r[1])));
+			v = _mm_add_ps(v, _mm_mul_ps(l2, _mm_set1_ps(r[2])));
+			v = _mm_add_ps(v, _mm_mul_ps(l3, _mm_set1_ps(r[3])));
+			_mm_storeu_ps(m.d + 4 * c, v);
+		}
+		return m;
+	}
+#endif
+
 	static DMat InvertNs(const DMat &m) {
 		DMat oM;
-		int r = InvertEx(m, &oM);
+		int r = Invert(m, &oM);
 		assert(r);
 		return oM;
 	}
 
+	/* Picks the cheapest correct inverse: InvertRigid, InvertAffine, then the general 4x4 inverse */
+	static bool Invert(const DMat &iMat, DMat *oMat) {
+		if (IsRigid(iMat))
+			return (*oMat = InvertRigid(iMat), true);
+		if (IsAffine(iMat))
+			return InvertAffine(iMat, oMat);
+#ifdef BU_DMAT_SSE2
+		return InvertExSse2(iMat, oMat);
+#else
+		return InvertEx(iMat, oMat);
+#endif
+	}
+
+	/* Bottom row exactly (0, 0, 0, 1) - what BlendGen.py produces for every bone and mesh matrix */
+	static bool IsAffine(const DMat &m) {
+		return DMAT_ELT(m, 3, 0) == 0.0f && DMAT_ELT(m, 3, 1) == 0.0f && DMAT_ELT(m, 3, 2) == 0.0f && DMAT_ELT(m, 3, 3) == 1.0f;
+	}
+
+	/* Affine with an orthonormal upper 3x3 (rotation, possibly a reflection, no scale) */
+	static bool IsRigid(const DMat &m) {
+		const float delta = 1e-5f;
+		if (!IsAffine(m))
+			return false;
+		for (int i = 0; i < 3; i++)
+			for (int j = i; j < 3; j++) {
+				float dot = DMAT_ELT(m, 0, i) * DMAT_ELT(m, 0, j) + DMAT_ELT(m, 1, i) * DMAT_ELT(m, 1, j) + DMAT_ELT(m, 2, i) * DMAT_ELT(m, 2, j);
+				if (std::fabsf(dot - (i == j ? 1.0f : 0.0f)) > delta)
+					return false;
+			}
+		return true;
+	}
+
+	/* [R t; 0 1]^-1 = [R^T -R^T*t; 0 1], valid only when IsRigid holds */
+	static DMat InvertRigid(const DMat &m) {
+		DMat o;
+		for (int r = 0; r < 3; r++) {
+			for (int c = 0; c < 3; c++)
+				DMAT_ELT(o, r, c) = DMAT_ELT(m, c, r);
+			DMAT_ELT(o, r, 3) = -(DMAT_ELT(m, 0, r) * DMAT_ELT(m, 0, 3) + DMAT_ELT(m, 1, r) * DMAT_ELT(m, 1, 3) + DMAT_ELT(m, 2, r) * DMAT_ELT(m, 2, 3));
+			DMAT_ELT(o, 3, r) = 0.0f;
+		}
+		DMAT_ELT(o, 3, 3) = 1.0f;
+		return o;
+	}
+
+	/* [A t; 0 1]^-1 = [A^-1 -A^-1*t; 0 1], A^-1 via the 3x3 adjugate. Valid only when IsAffine holds. */
+	static bool InvertAffine(const DMat &m, DMat *oMat) {
+		float a = DMAT_ELT(m, 0, 0), b = DMAT_ELT(m, 0, 1), c = DMAT_ELT(m, 0, 2);
+		float d = DMAT_ELT(m, 1, 0), e = DMAT_ELT(m, 1, 1), f = DMAT_ELT(m, 1, 2);
+		float g = DMAT_ELT(m, 2, 0), h = DMAT_ELT(m, 2, 1), i = DMAT_ELT(m, 2, 2);
+
+		float c00 = e * i - f * h, c01 = c * h - b * i, c02 = b * f - c * e;
+		float c10 = f * g - d * i, c11 = a * i - c * g, c12 = c * d - a * f;
+		float c20 = d * h - e * g, c21 = b * g - a * h, c22 = a * e - b * d;
+
+		float det = a * c00 + b * c10 + c * c20;
+		if (det == 0)
+			return false;
+		det = 1.0f / det;
+
+		DMat &o = *oMat;
+		DMAT_ELT(o, 0, 0) = c00 * det; DMAT_ELT(o, 0, 1) = c01 * det; DMAT_ELT(o, 0, 2) = c02 * det;
+		DMAT_ELT(o, 1, 0) = c10 * det; DMAT_ELT(o, 1, 1) = c11 * det; DMAT_ELT(o, 1, 2) = c12 * det;
+		DMAT_ELT(o, 2, 0) = c20 * det; DMAT_ELT(o, 2, 1) = c21 * det; DMAT_ELT(o, 2, 2) = c22 * det;
+
+		float tx = DMAT_ELT(m, 0, 3), ty = DMAT_ELT(m, 1, 3), tz = DMAT_ELT(m, 2, 3);
+		for (int r = 0; r < 3; r++) {
+			DMAT_ELT(o, r, 3) = -(DMAT_ELT(o, r, 0) * tx + DMAT_ELT(o, r, 1) * ty + DMAT_ELT(o, r, 2) * tz);
+			DMAT_ELT(o, 3, r) = 0.0f;
+		}
+		DMAT_ELT(o, 3, 3) = 1.0f;
+		return true;
+	}
+
 	static bool InvertEx(const DMat &iMat, DMat *oMat) {
 		/* This function accepts Column major order layout. */
 		/* Remember Row/Column major does matter, as: $(A^T)^-1 = (A^-1)^T$.
@@ -229,31 +408,529 @@ struct DMat {
 
 		return true;
 	}
+
+#ifdef BU_DMAT_SSE2
+	/* Cramer's rule on four lanes (after Intel AP-928, 'Streaming SIMD Extensions - Inverse of 4x4 Matrix').
+	*  Same cofactor expansion as InvertEx with the determinant divided exactly (no rcp estimate). */
+	static bool InvertExSse2(const DMat &iMat, DMat *oMat) {
+		const float *src = iMat.d;
+		__m128 minor0, minor1, minor2, minor3;
+		__m128 row0, row1, row2, row3;
+		__m128 det, tmp1;
+
+		tmp1 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64 *)(src + 0)), (const __m64 *)(src + 4));
+		row1 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64 *)(src + 8)), (const __m64 *)(src + 12));
+		row0 = _mm_shuffle_ps(tmp1, row1, 0x88);
+		row1 = _mm_shuffle_ps(row1, tmp1, 0xDD);
+		tmp1 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64 *)(src + 2)), (const __m64 *)(src + 6));
+		row3 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64 *)(src + 10)), (const __m64 *)(src + 14));
+		row2 = _mm_shuffle_ps(tmp1, row3, 0x88);
+		row3 = _mm_shuffle_ps(row3, tmp1, 0xDD);
+
+		tmp1   = _mm_mul_ps(row2, row3);
+		tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+		minor0 = _mm_mul_ps(row1, tmp1);
+		minor1 = _mm_mul_ps(row0, tmp1);
+		tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+		minor0 = _mm_sub_ps(_mm_mul_ps(row1, tmp1), minor0);
+		minor1 = _mm_sub_ps(_mm_mul_ps(row0, tmp1), minor1);
+		minor1 = _mm_shuffle_ps(minor1, minor1, 0x4E);
+
+		tmp1   = _mm_mul_ps(row1, row2);
+		tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+		minor0 = _mm_add_ps(_mm_mul_ps(row3, tmp1), minor0);
+		minor3 = _mm_mul_ps(row0, tmp1);
+		tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+		minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row3, tmp1));
+		minor3 = _mm_sub_ps(_mm_mul_ps(row0, tmp1), minor3);
+		minor3 = _mm_shuffle_ps(minor3, minor3, 0x4E);
+
+		tmp1   = _mm_mul_ps(_mm_shuffle_ps(row1, row1, 0x4E), row3);
+		tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+		row2   = _mm_shuffle_ps(row2, row2, 0x4E);
+		minor0 = _mm_add_ps(_mm_mul_ps(row2, tmp1), minor0);
+		minor2 = _mm_mul_ps(row0, tmp1);
+		tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+		minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row2, tmp1));
+		minor2 = _mm_sub_ps(_mm_mul_ps(row0, tmp1), minor2);
+		minor2 = _mm_shuffle_ps(minor2, minor2, 0x4E);
+
+		tmp1   = _mm_mul_ps(row0, row1);
+		tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+		minor2 = _mm_add_ps(_mm_mul_ps(row3, tmp1), minor2);
+		minor3 = _mm_sub_ps(_mm_mul_ps(row2, tmp1), minor3);
+		tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+		minor2 = _mm_sub_ps(_mm_mul_ps(row3, tmp1), minor2);
+		minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row2, tmp1));
+
+		tmp1   = _mm_mul_ps(row0, row3);
+		tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+		minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row2, tmp1));
+		minor2 = _mm_add_ps(_mm_mul_ps(row1, tmp1), minor2);
+		tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+		minor1 = _mm_add_ps(_mm_mul_ps(row2, tmp1), minor1);
+		minor2 = _mm_sub_ps(minor2, _mm_mul_ps(row1, tmp1));
+
+		tmp1   = _mm_mul_ps(row0, row2);
+		tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+		minor1 = _mm_add_ps(_mm_mul_ps(row3, tmp1), minor1);
+		minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row1, tmp1));
+		tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+		minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row3, tmp1));
+		minor3 = _mm_add_ps(_mm_mul_ps(row1, tmp1), minor3);
+
+		det = _mm_mul_ps(row0, minor0);
+		det = _mm_add_ps(_mm_shuffle_ps(det, det, 0x4E), det);
+		det = _mm_add_ss(_mm_shuffle_ps(det, det, 0xB1), det);
+
+		if (_mm_cvtss_f32(det) == 0)
+			return false;
+
+		det = _mm_div_ss(_mm_set_ss(1.0f), det);
+		det = _mm_shuffle_ps(det, det, 0x00);
+
+		float *dst = oMat->d;
+		_mm_storeu_ps(dst + 0, _mm_mul_ps(det, minor0));
+		_mm_storeu_ps(dst + 4, _mm_mul_ps(det, minor1));
+		_mm_storeu_ps(dst + 8, _mm_mul_ps(det, minor2));
+		_mm_storeu_ps(dst + 12, _mm_mul_ps(det, minor3));
+
+		return true;
+	}
+#endif
 };
 
+typedef void (*DMatMultiplyManyFn)(const DMat *lhs, const DMat *rhs, DMat *oM, int n);
+
+void DMatMultiplyManyScalar(const DMat *lhs, const DMat *rhs, DMat *oM, int n) {
+	for (int i = 0; i < n; i++)
+		oM[i] = DMat::MultiplyScalar(lhs[i], rhs[i]);
+}
+
+#ifdef BU_DMAT_SSE2
+void DMatMultiplyManySse2(const DMat *lhs, const DMat *rhs, DMat *oM, int n) {
+	for (int i = 0; i < n; i++)
+		oM[i] = DMat::MultiplySse2(lhs[i], rhs[i]);
+}
+#endif
+
+#ifdef BU_DMAT_AVX2
+/* Two result columns per 256-bit register: each lhs column is broadcast to both lanes,
+*  the in-lane shuffle broadcasts rhs(k,c) and rhs(k,c+1), and the four terms are chained with FMA.
+*  FMA rounds once per term, so results differ from MultiplyScalar in the last bits. */
+BU_TARGET_AVX2 void DMatMultiplyManyAvx2(const DMat *lhs, const DMat *rhs, DMat *oM, int n) {
+	for (int i = 0; i < n; i++) {
+		const float *l = lhs[i].d;
+		const float *r = rhs[i].d;
+		__m256 l0 = _mm256_broadcast_ps((const __m128 *)(l + 0));
+		__m256 l1 = _mm256_broadcast_ps((const __m128 *)(l + 4));
+		__m256 l2 = _mm256_broadcast_ps((const __m128 *)(l + 8));
+		__m256 l3 = _mm256_broadcast_ps((const __m128 *)(l + 12));
+		__m256 r01 = _mm256_loadu_ps(r + 0);
+		__m256 r23 = _mm256_loadu_ps(r + 8);
+
+		__m256 v01 = _mm256_mul_ps(l0, _mm256_shuffle_ps(r01, r01, 0x00));
+		v01 = _mm256_fmadd_ps(l1, _mm256_shuffle_ps(r01, r01, 0x55), v01);
+		v01 = _mm256_fmadd_ps(l2, _mm256_shuffle_ps(r01, r01, 0xAA), v01);
+		v01 = _mm256_fmadd_ps(l3, _mm256_shuffle_ps(r01, r01, 0xFF), v01);
+
+		__m256 v23 = _mm256_mul_ps(l0, _mm256_shuffle_ps(r23, r23, 0x00));
+		v23 = _mm256_fmadd_ps(l1, _mm256_shuffle_ps(r23, r23, 0x55), v23);
+		v23 = _mm256_fmadd_ps(l2, _mm256_shuffle_ps(r23, r23, 0xAA), v23);
+		v23 = _mm256_fmadd_ps(l3, _mm256_shuffle_ps(r23, r23, 0xFF), v23);
+
+		_mm256_storeu_ps(oM[i].d + 0, v01);
+		_mm256_storeu_ps(oM[i].d + 8, v23);
+	}
+	_mm256_zeroupper();
+}
+
+/* AVX2 and FMA present, and the OS saves YMM state (OSXSAVE + XCR0 bits 1,2) */
+bool BuCpuHasAvx2Fma() {
+#if defined(_MSC_VER)
+	int r[4];
+	__cpuid(r, 0);
+	if (r[0] < 7)
+		return false;
+	__cpuid(r, 1);
+	unsigned int ecx1 = r[2];
+	__cpuidex(r, 7, 0);
+	unsigned int ebx7 = r[1];
+	if (!(ecx1 & (1 << 27)))
+		return false;
+	unsigned long long xcr0 = _xgetbv(0);
+#else
+	unsigned int a, b, c, d;
+	if (__get_cpuid_max(0, NULL) < 7)
+		return false;
+	__cpuid(1, a, b, c, d);
+	unsigned int ecx1 = c;
+	__cpuid_count(7, 0, a, b, c, d);
+	unsigned int ebx7 = b;
+	if (!(ecx1 & (1 << 27)))
+		return false;
+	unsigned int xlo, xhi;
+	__asm__ ("xgetbv" : "=a" (xlo), "=d" (xhi) : "c" (0));
+	unsigned long long xcr0 = ((unsigned long long)xhi << 32) | xlo;
+#endif
+	bool fma  = (ecx1 & (1 << 12)) != 0;
+	bool avx  = (ecx1 & (1 << 28)) != 0;
+	bool avx2 = (ebx7 & (1 << 5)) != 0;
+	return fma && avx && avx2 && (xcr0 & 6) == 6;
+}
+#endif
+
+DMatMultiplyManyFn DMatKernelSelect(const char **oName = NULL) {
+	const char *dummy;
+	const char **name = oName ? oName : &dummy;
+#ifdef BU_DMAT_AVX2
+	if (BuCpuHasAvx2Fma())
+		return (*name = "avx2", DMatMultiplyManyAvx2);
+#endif
+#ifdef BU_DMAT_SSE2
+	return (*name = "sse2", DMatMultiplyManySse2);
+#else
+	return (*name = "scalar", DMatMultiplyManyScalar);
+#endif
+}
+
+/* Selected during static initialization, before any thread can call MultiplyMany */
+static const DMatMultiplyManyFn g_dmatMultiplyMany = DMatKernelSelect();
+
+void DMat::MultiplyMany(const DMat *lhs, const DMat *rhs, DMat *oM, int n) {
+	g_dmatMultiplyMany(lhs, rhs, oM, n);
+}
+
 struct DVec3 {
 	float d[3];
 };
 
+/* Unit dual quaternion r + e*d, components (x, y, z, w): r the rotation, d = 0.5 * (t, 0) * r carrying the translation */
+struct DDualQuat {
+	float r[4];
+	float d[4];
+
+	/* Rotation and translation of an affine matrix. Dual quaternions carry no scale:
+	*  columns are normalized first, so scaled bones come out rigid. */
+	static DDualQuat MakeFromMat(const DMat &mat) {
+		float m[3][3];
+		for (int c = 0; c < 3; c++) {
+			float len = sqrtf(DMAT_ELT(mat, 0, c) * DMAT_ELT(mat, 0, c) + DMAT_ELT(mat, 1, c) * DMAT_ELT(mat, 1, c) + DMAT_ELT(mat, 2, c) * DMAT_ELT(mat, 2, c));
+			float inv = len != 0.0f ? 1.0f / len : 0.0f;
+			for (int r = 0; r < 3; r++)
+				m[r][c] = DMAT_ELT(mat, r, c) * inv;
+		}
+
+		DDualQuat q;
+		float *r = q.r;
+		float trace = m[0][0] + m[1][1] + m[2][2];
+		if (trace > 0.0f) {
+			float s = sqrtf(trace + 1.0f) * 2.0f;
+			r[3] = 0.25f * s; r[0] = (m[2][1] - m[1][2]) / s; r[1] = (m[0][2] - m[2][0]) / s; r[2] = (m[1][0] - m[0][1]) / s;
+		} else if (m[0][0] > m[1][1] && m[0][0] > m[2][2]) {
+			float s = sqrtf(1.0f + m[0][0] - m[1][1] - m[2][2]) * 2.0f;
+			r[3] = (m[2][1] - m[1][2]) / s; r[0] = 0.25f * s; r[1] = (m[0][1] + m[1][0]) / s; r[2] = (m[0][2] + m[2][0]) / s;
+		} else if (m[1][1] > m[2][2]) {
+			float s = sqrtf(1.0f + m[1][1] - m[0][0] - m[2][2]) * 2.0f;
+			r[3] = (m[0][2] - m[2][0]) / s; r[0] = (m[0][1] + m[1][0]) / s; r[1] = 0.25f * s; r[2] = (m[1][2] + m[2][1]) / s;
+		} else {
+			float s = sqrtf(1.0f + m[2][2] - m[0][0] - m[1][1]) * 2.0f;
+			r[3] = (m[1][0] - m[0][1]) / s; r[0] = (m[0][2] + m[2][0]) / s; r[1] = (m[1][2] + m[2][1]) / s; r[2] = 0.25f * s;
+		}
+
+		float t[3] = { DMAT_ELT(mat, 0, 3), DMAT_ELT(mat, 1, 3), DMAT_ELT(mat, 2, 3) };
+		q.d[0] = 0.5f * ( t[0] * r[3] + t[1] * r[2] - t[2] * r[1]);
+		q.d[1] = 0.5f * (-t[0] * r[2] + t[1] * r[3] + t[2] * r[0]);
+		q.d[2] = 0.5f * ( t[0] * r[1] - t[1] * r[0] + t[2] * r[3]);
+		q.d[3] = -0.5f * (t[0] * r[0] + t[1] * r[1] + t[2] * r[2]);
+		return q;
+	}
+
+	static void MakeFromMatMany(const DMat *mat, DDualQuat *oQ, int n) {
+		for (int i = 0; i < n; i++)
+			oQ[i] = MakeFromMat(mat[i]);
+	}
+
+	/* Rotate then translate p by a unit dual quaternion */
+	static void Transform(const float *r, const float *d, const float *p, float *o) {
+		/* p + 2 * rv x (rv x p + rw * p) */
+		float a[3] = {
+			r[1] * p[2] - r[2] * p[1] + r[3] * p[0],
+			r[2] * p[0] - r[0] * p[2] + r[3] * p[1],
+			r[0] * p[1] - r[1] * p[0] + r[3] * p[2],
+		};
+		/* 2 * (rw * dv - dw * rv + rv x dv) */
+		float t[3] = {
+			2.0f * (r[3] * d[0] - d[3] * r[0] + r[1] * d[2] - r[2] * d[1]),
+			2.0f * (r[3] * d[1] - d[3] * r[1] + r[2] * d[0] - r[0] * d[2]),
+			2.0f * (r[3] * d[2] - d[3] * r[2] + r[0] * d[1] - r[1] * d[0]),
+		};
+		o[0] = p[0] + 2.0f * (r[1] * a[2] - r[2] * a[1]) + t[0];
+		o[1] = p[1] + 2.0f * (r[2] * a[0] - r[0] * a[2]) + t[1];
+		o[2] = p[2] + 2.0f * (r[0] * a[1] - r[1] * a[0]) + t[2];
+	}
+};
+
+/* Local bone pose: translation, rotation quaternion (x, y, z, w) and scale, each padded to four floats for SSE */
+struct DTrs {
+	float t[4];
+	float r[4];
+	float s[4];
+
+	static DTrs MakeIdentity() {
+		DTrs p = {
+			{ 0.0f, 0.0f, 0.0f, 0.0f },
+			{ 0.0f, 0.0f, 0.0f, 1.0f },
+			{ 1.0f, 1.0f, 1.0f, 0.0f },
+		};
+		return p;
+	}
+
+	/* T * R * S, the order Blender composes a pose bone's matrix_basis in */
+	DMat ToMat() const {
+		float x = r[0], y = r[1], z = r[2], w = r[3];
+		DMat m;
+		DMAT_ELT(m, 0, 0) = (1 - 2 * (y * y + z * z)) * s[0]; DMAT_ELT(m, 0, 1) = 2 * (x * y - z * w) * s[1]; DMAT_ELT(m, 0, 2) = 2 * (x * z + y * w) * s[2]; DMAT_ELT(m, 0, 3) = t[0];
+		DMAT_ELT(m, 1, 0) = 2 * (x * y + z * w) * s[0]; DMAT_ELT(m, 1, 1) = (1 - 2 * (x * x + z * z)) * s[1]; DMAT_ELT(m, 1, 2) = 2 * (y * z - x * w) * s[2]; DMAT_ELT(m, 1, 3) = t[1];
+		DMAT_ELT(m, 2, 0) = 2 * (x * z - y * w) * s[0]; DMAT_ELT(m, 2, 1) = 2 * (y * z + x * w) * s[1]; DMAT_ELT(m, 2, 2) = (1 - 2 * (x * x + y * y)) * s[2]; DMAT_ELT(m, 2, 3) = t[2];
+		DMAT_ELT(m, 3, 0) = 0.0f; DMAT_ELT(m, 3, 1) = 0.0f; DMAT_ELT(m, 3, 2) = 0.0f; DMAT_ELT(m, 3, 3) = 1.0f;
+		return m;
+	}
+};
+
+#ifdef BU_DMAT_SSE2
+/* Dot product of two four-float vectors, broadcast to all lanes */
+inline __m128 BuDot4Sse2(__m128 a, __m128 b) {
+	__m128 m = _mm_mul_ps(a, b);
+	m = _mm_add_ps(m, _mm_shuffle_ps(m, m, 0x4E));
+	return _mm_add_ps(m, _mm_shuffle_ps(m, m, 0xB1));
+}
+#endif
+
+/* o = a + (b - a) * f over four floats */
+inline void Vec4Lerp(const float *a, const float *b, float f, float *o) {
+#ifdef BU_DMAT_SSE2
+	__m128 va = _mm_loadu_ps(a);
+	_mm_storeu_ps(o, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b), va), _mm_set1_ps(f))));
+#else
+	for (int i = 0; i < 4; i++)
+		o[i] = a[i] + (b[i] - a[i]) * f;
+#endif
+}
+
+#ifdef BU_DMAT_SSE2
+inline __m128 QuatNlerpSse2(__m128 qa, __m128 qb, float f) {
+	if (_mm_cvtss_f32(BuDot4Sse2(qa, qb)) < 0.0f)
+		qb = _mm_sub_ps(_mm_setzero_ps(), qb);
+	__m128 q = _mm_add_ps(qa, _mm_mul_ps(_mm_sub_ps(qb, qa), _mm_set1_ps(f)));
+	return _mm_div_ps(q, _mm_sqrt_ps(BuDot4Sse2(q, q)));
+}
+#endif
+
+/* Shortest-path normalized lerp of unit quaternions */
+inline void QuatNlerp(const float *a, const float *b, float f, float *o) {
+#ifdef BU_DMAT_SSE2
+	_mm_storeu_ps(o, QuatNlerpSse2(_mm_loadu_ps(a), _mm_loadu_ps(b), f));
+#else
+	float sign = (a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]) < 0.0f ? -1.0f : 1.0f;
+	float q[4], len = 0.0f;
+	for (int i = 0; i < 4; i++)
+		len += (q[i] = a[i] + (sign * b[i] - a[i]) * f) * q[i];
+	len = sqrtf(len);
+	for (int i = 0; i < 4; i++)
+		o[i] = q[i] / len;
+#endif
+}
+
+/* Shortest-path spherical lerp of unit quaternions; nearly parallel inputs go through QuatNlerp */
+inline void QuatSlerp(const float *a, const float *b, float f, float *o) {
+	float dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+	float sign = dot < 0.0f ? -1.0f : 1.0f;
+	dot *= sign;
+
+	if (dot > 0.9995f) {
+		QuatNlerp(a, b, f, o);
+		return;
+	}
+
+	float theta = acosf(dot);
+	float inv = 1.0f / sinf(theta);
+	float wa = sinf((1.0f - f) * theta) * inv;
+	float wb = sinf(f * theta) * inv * sign;
+#ifdef BU_DMAT_SSE2
+	_mm_storeu_ps(o, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a), _mm_set1_ps(wa)), _mm_mul_ps(_mm_loadu_ps(b), _mm_set1_ps(wb))));
+#else
+	for (int i = 0; i < 4; i++)
+		o[i] = a[i] * wa + b[i] * wb;
+#endif
+}
+
+/* Unit quaternion in 48 bits, held as three uint16_t (bits 0-15, 16-31, 32-47; the ANIMCHANPACK byte order on little endian):
+*  index of the dropped (largest, made positive) component in the top 2 bits, then the other three in order
+*  as 15 bit unorms over [-1/sqrt(2), 1/sqrt(2)] at bits 31, 16 and 1. Same packing as BlendGen.py animQuatPackSmallest3. */
+inline void QuatSmallest3Encode(const float *q, uint16_t *o) {
+	const float lim = 0.70710678f;
+	const int shift[3] = { 31, 16, 1 };
+
+	int idx = 0;
+	for (int i = 1; i < 4; i++)
+		if (std::fabsf(q[i]) > std::fabsf(q[idx]))
+			idx = i;
+	float sign = q[idx] < 0.0f ? -1.0f : 1.0f;
+
+	uint64_t bits = (uint64_t)idx << 46;
+	for (int i = 0, j = 0; i < 4; i++) {
+		if (i == idx)
+			continue;
+		float v = min(max(sign * q[i], -lim), lim);
+		bits |= (uint64_t)(int)floorf((v / lim * 0.5f + 0.5f) * 32767.0f + 0.5f) << shift[j++];
+	}
+
+	o[0] = (uint16_t)bits; o[1] = (uint16_t)(bits >> 16); o[2] = (uint16_t)(bits >> 32);
+}
+
+inline void QuatSmallest3Decode(const uint16_t *b, float *oQ) {
+	const float lim = 0.70710678f;
+	const int shift[3] = { 31, 16, 1 };
+
+	uint64_t bits = (uint64_t)b[0] | (uint64_t)b[1] << 16 | (uint64_t)b[2] << 32;
+	int idx = (int)(bits >> 46) & 3;
+	float sum = 0.0f;
+	for (int i = 0, j = 0; i < 4; i++) {
+		if (i == idx)
+			continue;
+		float v = (float)((bits >> shift[j++]) & 0x7FFF) * (2.0f * lim / 32767.0f) - lim;
+		oQ[i] = v;
+		sum += v * v;
+	}
+	oQ[idx] = sqrtf(max(0.0f, 1.0f - sum));
+}
+
+#ifdef BU_DMAT_SSE2
+/* QuatSmallest3Decode kept in a register and free of branches on the dropped index (random across keys of a track
+*  that swings through 45 degrees): lanes (c0, c1, c2, w) go into place by one of four shuffles, picked by mask. */
+inline __m128 QuatSmallest3DecodeSse2(const uint16_t *b) {
+	const float lim = 0.70710678f;
+
+	uint64_t bits = (uint64_t)b[0] | (uint64_t)b[1] << 16 | (uint64_t)b[2] << 32;
+	__m128i idx = _mm_set1_epi32((int)(bits >> 46) & 3);
+	__m128i c = _mm_setr_epi32((int)(bits >> 31) & 0x7FFF, (int)(bits >> 16) & 0x7FFF, (int)(bits >> 1) & 0x7FFF, 0);
+
+	/* Lane 3 comes out 0 and receives w */
+	__m128 v = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(c), _mm_set1_ps(2.0f * lim / 32767.0f)), _mm_setr_ps(lim, lim, lim, 0.0f));
+	__m128 w = _mm_sqrt_ps(_mm_max_ps(_mm_setzero_ps(), _mm_sub_ps(_mm_set1_ps(1.0f), BuDot4Sse2(v, v))));
+	v = _mm_add_ps(v, _mm_and_ps(w, _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1))));
+
+	__m128 r;
+	r = _mm_and_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(idx, _mm_set1_epi32(3))), v);
+	r = _mm_or_ps(r, _mm_and_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(idx, _mm_set1_epi32(2))), _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 1, 0))));
+	r = _mm_or_ps(r, _mm_and_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(idx, _mm_set1_epi32(1))), _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 1, 3, 0))));
+	r = _mm_or_ps(r, _mm_and_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(idx, _mm_set1_epi32(0))), _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 1, 0, 3))));
+	return r;
+}
+#endif
+
 bool ScaZero(float a) {
 	const float delta = 0.001f;
 	return (std::fabsf(a) < delta);
 }
 
+class MMapFile {
+	const char *data;
+	int size;
+#ifdef _WIN32
+	HANDLE hFile, hMap;
+#endif
+
+	MMapFile(const MMapFile &other);
+	MMapFile & operator=(const MMapFile &other);
+public:
+	MMapFile(const string &fname) : data(NULL), size(0) {
+#ifdef _WIN32
+		hMap = NULL;
+		hFile = CreateFileA(fname.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (hFile == INVALID_HANDLE_VALUE)
+			throw ExcFileOpen();
+
+		LARGE_INTEGER fsize;
+		BOOL r = GetFileSizeEx(hFile, &fsize);
+		assert(r && fsize.QuadPart <= INT_MAX);
+		size = (int)fsize.QuadPart;
+
+		/* Zero-length files cannot be mapped */
+		if (size) {
+			hMap = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+			assert(hMap);
+			data = (const char *)MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0);
+			assert(data);
+		}
+#else
+		int fd = open(fname.c_str(), O_RDONLY);
+		if (fd == -1)
+			throw ExcFileOpen();
+
+		struct stat st;
+		int r = fstat(fd, &st);
+		assert(r == 0 && st.st_size <= INT_MAX);
+		size = (int)st.st_size;
+
+		/* Zero-length files cannot be mapped */
+		if (size) {
+			void *m = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			assert(m != MAP_FAILED);
+			/* Sections are decoded front to back */
+			posix_madvise(m, size, POSIX_MADV_SEQUENTIAL);
+			data = (const char *)m;
+		}
+
+		close(fd);
+#endif
+	}
+
+	~MMapFile() {
+#ifdef _WIN32
+		if (data)
+			UnmapViewOfFile(data);
+		if (hMap)
+			CloseHandle(hMap);
+		CloseHandle(hFile);
+#else
+		if (data)
+			munmap((void *)data, size);
+#endif
+	}
+
+	const char *Data() const {
+		/* Stand-in for the empty file case, so that CharPtrRel(0) stays valid */
+		return data ? data : "";
+	}
+
+	int Size() const {
+		return size;
+	}
+};
+
 class Slice {
+	/* Backing bytes - a string or a file mapping, kept alive by the shared ownership */
+	shared_ptr<const char> s;
+	int sSize;
 	int beg, end;
-	shared_ptr<string> s;
 public:
-	Slice(slice_str_t _, const string &s) : s(new string(s)), beg(0), end(s.size()) {}
-	Slice(slice_reslice_abs_t _, const Slice &other, int beg, int end) : s(other.s), beg(beg), end(end) {
+	Slice(slice_str_t _, const string &s) : sSize(s.size()), beg(0), end(s.size()) {
+		shared_ptr<string> str(new string(s));
+		this->s = shared_ptr<const char>(str, str->data());
+	}
+	Slice(slice_str_t _, const shared_ptr<string> &s) : s(s, s->data()), sSize(s->size()), beg(0), end(s->size()) {}
+	Slice(slice_mmap_t _, const shared_ptr<MMapFile> &m) : s(m, m->Data()), sSize(m->Size()), beg(0), end(m->Size()) {}
+	Slice(slice_reslice_abs_t _, const Slice &other, int beg, int end) : s(other.s), sSize(other.sSize), beg(beg), end(end) {
 		assert(beg >= other.beg && beg <= end && end <= other.end);
 	}
-	Slice(slice_reslice_rel_t _, const Slice &other, int beg, int end) : s(other.s), beg(other.beg + beg), end(other.beg + end) {
+	Slice(slice_reslice_rel_t _, const Slice &other, int beg, int end) : s(other.s), sSize(other.sSize), beg(other.beg + beg), end(other.beg + end) {
 		assert(this->beg >= other.beg && this->beg <= this->end && this->end <= other.end);
 	}
 
 	bool Check() const {
-		return beg >= 0 && beg <= end && end <= (long)s->size();
+		return beg >= 0 && beg <= end && end <= sSize;
 	}
 
 	bool CheckRelRange(int rel) const {
@@ -272,18 +949,130 @@ public:
 
 	const char *CharPtrRel(int rel) const {
 		assert(CheckRelRange(rel));
-		return &s->data()[beg + rel];
+		return &s.get()[beg + rel];
 	}
 };
 
 class Section {
 public:
 	string name;
+	/* Reslice of the buffer the Section was read from (no copy) */
 	Slice  data;
 
 	Section(const string &name, const Slice &data) : name(name), data(data) {}
 };
 
+/* .dat v2: a 16 byte file header [char magic[4], int version, int lenHeader, int reserved], then sections of
+*  [int lenTotal, int lenName, int lenData, uint crc, name, pad, data, pad].
+*  Every section header and payload starts 16 byte aligned relative to the file (and so in the mapping).
+*  The crc is CRC32C over name then data, the padding is not covered. lenTotal includes the trailing padding,
+*  which the last section (SECTIONTOC) omits so that its trailing int stays at the end of the file.
+*  Files without the magic are v1: [int lenTotal, int lenName, int lenData, name, data] packed back to back. */
+static const char BU_DAT_MAGIC[4] = { 'B', 'U', 'D', 'T' };
+#define BU_DAT_VERSION 2
+#define BU_DAT_ALIGN 16
+#define BU_DAT_HEADER 16
+#define BU_DAT_SECTION_HEADER_V1 (4+4+4)
+#define BU_DAT_SECTION_HEADER_V2 (4+4+4+4)
+
+inline int DatAlign(int n) {
+	return (n + BU_DAT_ALIGN - 1) & ~(BU_DAT_ALIGN - 1);
+}
+
+/* The crc does not cover the v2 section header, so its lengths are checked for agreement here instead.
+*  Readers report a header failing this like a payload failing its crc (ExcChecksum). */
+inline bool DatCheckSectionHeaderV2(int lenTotal, int lenName, int lenData) {
+	if (lenName < 0 || lenData < 0)
+		return false;
+
+	/* 64 bit so that damaged lengths cannot wrap around into agreement */
+	long long lenUsed = BU_DAT_SECTION_HEADER_V2 + (((long long)lenName + BU_DAT_ALIGN - 1) & ~(long long)(BU_DAT_ALIGN - 1)) + lenData;
+
+	return lenTotal >= lenUsed && lenTotal - lenUsed < BU_DAT_ALIGN;
+}
+
+/* Castagnoli polynomial (reflected), byte at a time */
+class Crc32cTable {
+public:
+	uint32_t t[256];
+
+	Crc32cTable() {
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t c = i;
+			for (int k = 0; k < 8; k++)
+				c = (c >> 1) ^ (0x82F63B78 & (0 - (c & 1)));
+			t[i] = c;
+		}
+	}
+};
+
+static const Crc32cTable g_crc32cTable;
+
+/* 'crc' is the running value - start from 0 and chain calls to cover discontiguous spans */
+uint32_t Crc32cScalar(uint32_t crc, const void *data, int n) {
+	const unsigned char *c = (const unsigned char *)data;
+
+	crc = ~crc;
+	for (int i = 0; i < n; i++)
+		crc = g_crc32cTable.t[(crc ^ c[i]) & 0xFF] ^ (crc >> 8);
+
+	return ~crc;
+}
+
+#ifdef BU_CRC32C_SSE42
+BU_TARGET_SSE42 uint32_t Crc32cSse42(uint32_t crc, const void *data, int n) {
+	const unsigned char *c = (const unsigned char *)data;
+	int i = 0;
+
+	crc = ~crc;
+	for (; i < n && ((uintptr_t)(c + i) & 7); i++)
+		crc = _mm_crc32_u8(crc, c[i]);
+#  if defined(_M_X64) || defined(__x86_64__)
+	uint64_t crc64 = crc;
+	for (; i + 8 <= n; i += 8)
+		crc64 = _mm_crc32_u64(crc64, *(const uint64_t *)(c + i));
+	crc = (uint32_t)crc64;
+#  endif
+	for (; i + 4 <= n; i += 4)
+		crc = _mm_crc32_u32(crc, *(const uint32_t *)(c + i));
+	for (; i < n; i++)
+		crc = _mm_crc32_u8(crc, c[i]);
+
+	return ~crc;
+}
+
+bool BuCpuHasSse42() {
+#  if defined(_MSC_VER)
+	int r[4];
+	__cpuid(r, 1);
+	unsigned int ecx1 = r[2];
+#  else
+	unsigned int a, b, ecx1, d;
+	if (!__get_cpuid(1, &a, &b, &ecx1, &d))
+		return false;
+#  endif
+	return (ecx1 & (1 << 20)) != 0;
+}
+#endif
+
+typedef uint32_t (*Crc32cFn)(uint32_t crc, const void *data, int n);
+
+Crc32cFn Crc32cKernelSelect(const char **oName = NULL) {
+	const char *dummy;
+	const char **name = oName ? oName : &dummy;
+#ifdef BU_CRC32C_SSE42
+	if (BuCpuHasSse42())
+		return (*name = "sse4.2", Crc32cSse42);
+#endif
+	return (*name = "table", Crc32cScalar);
+}
+
+static const Crc32cFn g_crc32c = Crc32cKernelSelect();
+
+uint32_t Crc32c(uint32_t crc, const void *data, int n) {
+	return g_crc32c(crc, data, n);
+}
+
 class P {
 	int p;
 	Slice s;
@@ -293,6 +1082,11 @@ public:
 	P(const P &other) : p(other.p), s(other.s) {}
 	~P() {}
 
+	P SubRel(int rel, int n) const {
+		assert(BytesLeft() >= rel + n);
+		return P(Slice(slice_reslice_rel_t(), s, p + rel, p + rel + n));
+	}
+
 	/* Cruft Start */
 	void OptSkipWs() {
 		P w(*this);
@@ -340,7 +1134,7 @@ public:
 		return s.BytesLeftRel(p);
 	}
 
-	bool CheckIntArbitraryLimit(int i) {
+	static bool CheckIntArbitraryLimit(int i) {
 		return i == -1 || (i >= 0 && i <= 1024 * 1024);
 	}
 
@@ -354,26 +1148,58 @@ public:
 	}
 
 	int ReadInt() {
-		assert(BytesLeft() >= 4);
+		int i = ReadIntUnchecked();
+
+		assert(CheckIntArbitraryLimit(i));
 
+		return i;
+	}
+
+	/* For probing data that may turn out not to be an int at all (See Parse::ReadSectionToc) */
+	int ReadIntUnchecked() {
 		/* SCNd8 : See n1256@7.8.1/4 */
 		/* sscanf(s.CharPtrRel(p), "" SCNd32 "", &i32); */
-		union { int32_t i; char c[4]; } uni;
-		memcpy(&uni.c, s.CharPtrRel(p), 4);
+		int32_t i;
+		ReadBulk32(&i, 1);
 
-		assert(CheckIntArbitraryLimit(uni.i));
-
-		return (AdvanceInt(), uni.i);
+		return i;
 	}
 
 	float ReadFloat() {
-		assert(BytesLeft() >= 4);
+		float f;
+		ReadBulk32(&f, 1);
+
+		return f;
+	}
+
+	/* Reads 'n' consecutive little endian 4 byte values (int32_t or float) into 'dst' in one go. */
+	void ReadBulk32(void *dst, int n) {
+		assert(n >= 0 && BytesLeft() >= 4 * n);
+
+		memcpy(dst, s.CharPtrRel(p), 4 * n);
+
+		if (!HostIsLittleEndian()) {
+			char *c = (char *)dst;
+			for (int i = 0; i < n; i++, c += 4) {
+				swap(c[0], c[3]);
+				swap(c[1], c[2]);
+			}
+		}
+
+		AdvanceN(4 * n);
+	}
 
-		/* FIXME: Yes the union thing */
-		union { float f; char c[4]; } uni;
-		memcpy(&uni.c, s.CharPtrRel(p), 4);
+	void ReadBytes(void *dst, int n) {
+		assert(n >= 0 && BytesLeft() >= n);
 
-		return (AdvanceN(4), uni.f);
+		memcpy(dst, s.CharPtrRel(p), n);
+
+		AdvanceN(n);
+	}
+
+	static bool HostIsLittleEndian() {
+		const uint32_t one = 1;
+		return *(const char *)&one == 1;
 	}
 
 	string ReadString(int n) {
@@ -384,6 +1210,15 @@ public:
 		return (AdvanceN(n), ret);
 	}
 
+	Slice ReadSlice(int n) {
+		assert(BytesLeft() >= n);
+
+		/* No copy - the returned Slice shares the backing buffer */
+		Slice ret(slice_reslice_rel_t(), s, p, p + n);
+
+		return (AdvanceN(n), ret);
+	}
+
 	string ReadLenDel() {
 		P w(*this);
 
@@ -396,6 +1231,18 @@ public:
 		return (*this = w, data);
 	}
 
+	Slice ReadLenDelSlice() {
+		P w(*this);
+
+		assert(w.BytesLeft() >= 4);
+
+		int   len  = w.ReadInt();
+		assert(CheckIntArbitraryLimit(len));
+		Slice data = w.ReadSlice(len);
+
+		return (*this = w, data);
+	}
+
 	Section ReadSectionWeak() {
 		P w(*this);
 
@@ -409,125 +1256,2239 @@ public:
 
 		assert(lenTotal == 4+4+4+lenName+lenData);
 
-		string name, data;
+		string name;
 
 		name = w.ReadString(lenName);
-		data = w.ReadString(lenData);
+		Slice data = w.ReadSlice(lenData);
 
-		return (*this = w, Section(name, Slice(slice_str_t(), data)));
+		return (*this = w, Section(name, data));
 	}
-};
 
-class SectionData {
-public:
-	vector<string> meshName;
-	vector<int>    meshParent;
-	vector<DMat>   meshMatrix;
+	/* v2 section, verifying the header lengths and the checksum (See BU_DAT_MAGIC) */
+	Section ReadSectionWeakV2() {
+		P w(*this);
 
-	vector<string> boneName;
-	vector<int>    boneParent;
-	vector<DMat>   boneMatrix;
+		if (w.BytesLeft() < BU_DAT_SECTION_HEADER_V2)
+			throw ExcChecksum();
 
-	vector<vector<float> > meshVert;
-	vector<vector<int> >   meshIndex;
+		int lenTotal, lenName, lenData;
 
-	/* [Mesh0: [Vert0: id*BU_MAX_INFLUENCING_BONE ...] ...] */
-	vector<vector<int> >   meshVertId;
-	vector<vector<float> > meshVertWt;
+		lenTotal = w.ReadIntUnchecked();
+		lenName  = w.ReadIntUnchecked();
+		lenData  = w.ReadIntUnchecked();
+		uint32_t crc = (uint32_t)w.ReadIntUnchecked();
 
-	vector<vector<int> > meshChild;
-	vector<vector<int> > boneChild;
+		if (!DatCheckSectionHeaderV2(lenTotal, lenName, lenData) || w.BytesLeft() < lenTotal - BU_DAT_SECTION_HEADER_V2)
+			throw ExcChecksum();
+
+		int lenUsed = BU_DAT_SECTION_HEADER_V2 + DatAlign(lenName) + lenData;
+
+		string name = w.ReadString(lenName);
+		w.AdvanceN(DatAlign(lenName) - lenName);
+		Slice data = w.ReadSlice(lenData);
+		w.AdvanceN(lenTotal - lenUsed);
+
+		if (Crc32c(Crc32c(0, name.data(), lenName), data.CharPtrRel(0), lenData) != crc)
+			throw ExcChecksum();
+
+		return (*this = w, Section(name, data));
+	}
+
+	Section ReadSectionWeak(int version) {
+		return version == 1 ? ReadSectionWeak() : ReadSectionWeakV2();
+	}
 };
 
-class SectionDataEx : public SectionData {
+class SectionHeader {
 public:
+	int lenTotal, lenName, lenData;
+	/* v2 only */
+	uint32_t crc;
 };
 
-bool MultiRootReachabilityCheck(const vector<vector<int> > &child, const vector<int> &parent) {
-	assert(child.size() == parent.size());
+/* Pull reader for sections straight off a file, one section resident at a time.
+*  Headers are available as soon as their 12 bytes are read, the body can then be read or skipped. */
+class SectionStream {
+	FILE *f;
+	int version;
 
-	vector<int> w(child.size(), 0);
+	SectionStream(const SectionStream &other);
+	SectionStream & operator=(const SectionStream &other);
 
-	std::function<void(int)> rec;
-	rec = [&rec, &child, &w](int state) {
-		w[state] += 1;
+	int mLenHeader() const {
+		return version == 1 ? BU_DAT_SECTION_HEADER_V1 : BU_DAT_SECTION_HEADER_V2;
+	}
 
-		for (auto &i : child[state])
-			rec(i);
-	};
+	int mOffData(const SectionHeader &hdr) const {
+		return version == 1 ? hdr.lenName : DatAlign(hdr.lenName);
+	}
+public:
+	SectionStream(const string &fname) : version(1) {
+		f = fopen(fname.c_str(), "rb");
+		if (!f)
+			throw ExcFileOpen();
+
+		/* A v1 file has no header - rewind and read its first section instead */
+		char buf[BU_DAT_HEADER];
+		int r = fread(buf, 1, sizeof buf, f);
+		if (r == sizeof buf && memcmp(buf, BU_DAT_MAGIC, sizeof BU_DAT_MAGIC) == 0) {
+			P w(string(buf, sizeof buf));
+			w.AdvanceN(sizeof BU_DAT_MAGIC);
+			version = w.ReadInt();
+			int lenHeader = w.ReadInt();
+			if (version != BU_DAT_VERSION) {
+				fclose(f);
+				throw ExcVersion();
+			}
+			assert(lenHeader == BU_DAT_HEADER);
+		} else {
+			int r = fseek(f, 0, SEEK_SET);
+			assert(r == 0);
+		}
+	}
 
-	for (int i = 0; i < parent.size(); i++)
-		if (parent[i] == -1)
-			rec(i);
+	~SectionStream() {
+		fclose(f);
+	}
 
-	bool allReachable   = accumulate(w.begin(), w.end(), true, [](int a, int x) { return a && x; });
-	bool allReachedOnce = accumulate(w.begin(), w.end(), true, [](int a, int x) { return a && (x == 1); });
+	bool ReadHeader(SectionHeader *oHdr) {
+		char buf[BU_DAT_SECTION_HEADER_V2];
+		int r = fread(buf, 1, mLenHeader(), f);
 
-	return allReachable && allReachedOnce;
-}
+		/* Clean end of stream only at a section boundary */
+		if (r == 0 && feof(f))
+			return false;
 
-void MatrixAccumulateWorld(const vector<DMat> &mLocal, const vector<vector<int> > &child, int state, const DMat &mInitial, vector<DMat> *oWorld) {
-	assert(oWorld->size() == mLocal.size());
+		if (version == 1) {
+			assert(r == mLenHeader());
+
+			P w(string(buf, mLenHeader()));
+			oHdr->lenTotal = w.ReadInt();
+			oHdr->lenName  = w.ReadInt();
+			oHdr->lenData  = w.ReadInt();
+			oHdr->crc      = 0;
+
+			assert(oHdr->lenName >= 0 && oHdr->lenData >= 0);
+			assert(oHdr->lenTotal == 4+4+4+oHdr->lenName+oHdr->lenData);
+		} else {
+			if (r != mLenHeader())
+				throw ExcChecksum();
+
+			P w(string(buf, mLenHeader()));
+			oHdr->lenTotal = w.ReadIntUnchecked();
+			oHdr->lenName  = w.ReadIntUnchecked();
+			oHdr->lenData  = w.ReadIntUnchecked();
+			oHdr->crc      = (uint32_t)w.ReadIntUnchecked();
+
+			if (!DatCheckSectionHeaderV2(oHdr->lenTotal, oHdr->lenName, oHdr->lenData))
+				throw ExcChecksum();
+		}
 
-	std::function<void(int, const DMat &)> rec;
-	rec = [&rec, &mLocal, &child, &oWorld](int state, const DMat &acc) {
-		DMat newAcc = DMat::Multiply(acc, mLocal[state]);
-		(*oWorld)[state] = newAcc;
+		return true;
+	}
 
-		for (auto &i : child[state])
-			rec(i, newAcc);
-	};
+	/* The payload keeps its offset within the section, so it is as aligned as the string allocation */
+	Section ReadBody(const SectionHeader &hdr) {
+		int offData = mOffData(hdr);
+		int lenBody = hdr.lenTotal - mLenHeader();
+		shared_ptr<string> acc(new string(lenBody, '\0'));
+
+		if (acc->size()) {
+			int r = fread(&(*acc)[0], 1, acc->size(), f);
+			/* A v2 header past the real end of the file is damage like any other (See ReadHeader) */
+			if (version != 1 && r != acc->size())
+				throw ExcChecksum();
+			assert(r == acc->size());
+		}
 
-	rec(state, mInitial);
-}
+		Slice all(slice_str_t(), acc);
+		Section sec(acc->substr(0, hdr.lenName), Slice(slice_reslice_rel_t(), all, offData, offData + hdr.lenData));
 
-void MultiRootMatrixAccumulateWorld(const vector<DMat> &mLocal, const vector<vector<int> > &child, const vector<int> &parent, const vector<DMat> root, vector<DMat> *oWorld) {
-	assert(mLocal.size() == child.size() && mLocal.size() == parent.size() && mLocal.size() == oWorld->size());
-	assert(MultiRootReachabilityCheck(child, parent));
+		if (version != 1 && Crc32c(Crc32c(0, sec.name.data(), hdr.lenName), sec.data.CharPtrRel(0), hdr.lenData) != hdr.crc)
+			throw ExcChecksum();
 
-	for (int i = 0; i < parent.size(); i++)
-		if (parent[i] == -1)
-			MatrixAccumulateWorld(mLocal, child, i, root[i], oWorld);
-}
+		return sec;
+	}
 
-void MatrixMeshToBone(const vector<DMat> &meshWorldMatrix, const vector<DMat> &boneWorldMatrix, vector<vector<DMat> > *oWorld) {
-	int numMesh = meshWorldMatrix.size();
-	int numAllBone = boneWorldMatrix.size();
+	void SkipBody(const SectionHeader &hdr) {
+		int r = fseek(f, hdr.lenTotal - mLenHeader(), SEEK_CUR);
+		assert(r == 0);
+	}
 
-	assert(oWorld->size() == boneWorldMatrix.size());
-	
-	vector<vector<DMat>> ret;
+	bool ReadSection(Section *oSec) {
+		SectionHeader hdr;
 
-	for (int m = 0; m < numMesh; m++) {
-		vector<DMat> v;
-		for (int b = 0; b < numAllBone; b++) {
-			const DMat mMeshBone = DMat::Multiply(meshWorldMatrix[m], DMat::InvertNs(boneWorldMatrix[b]));
-			v.push_back(mMeshBone);
-		}
-		ret.push_back(v);
+		if (!ReadHeader(&hdr))
+			return false;
+
+		*oSec = ReadBody(hdr);
+
+		return true;
 	}
+};
 
-	*oWorld = ret;
-}
+/* Runs a SectionStream on a background thread, handing sections over through a queue bounded by maxBytes of payload.
+*  A single section larger than maxBytes is still let through once the queue drains. */
+class SectionPipeline {
+	SectionStream stream;
+	int maxBytes;
 
-class Parse {
-public:
-	static vector<Section> ReadSection(const P &inP) {
-		vector<Section> sec;
-		P w(inP);
+	mutex mtx;
+	condition_variable cv;
+	deque<Section> q;
+	int qBytes;
+	bool done;
+	/* Set by the reader on a checksum mismatch, reported by Pop once the good sections before it are drained */
+	bool corrupt;
 
-		int bleft = w.BytesLeft() + 1;
+	thread reader;
 
-		while (w.BytesLeft() < bleft && (bleft = w.BytesLeft()) != 0) {
-			sec.push_back(Section(w.ReadSectionWeak()));
+	SectionPipeline(const SectionPipeline &other);
+	SectionPipeline & operator=(const SectionPipeline &other);
+
+	void mRun() {
+		Section sec("", Slice(slice_str_t(), string()));
+
+		bool bad = false;
+
+		try {
+			while (stream.ReadSection(&sec)) {
+				unique_lock<mutex> lock(mtx);
+				cv.wait(lock, [this, &sec]() { return q.empty() || qBytes + sec.data.size() <= maxBytes; });
+				qBytes += sec.data.size();
+				q.push_back(sec);
+				cv.notify_all();
+			}
+		} catch (ExcChecksum &) {
+			bad = true;
 		}
 
-		return sec;
+		unique_lock<mutex> lock(mtx);
+		done = true;
+		corrupt = bad;
+		cv.notify_all();
 	}
 
-	static bool SectionExistByName(const vector<Section> &sec, const string &name) {
-		for (auto &i : sec)
-			if (i.name == name)
+public:
+	SectionPipeline(const string &fname, int maxBytes) :
+		stream(fname), maxBytes(maxBytes), qBytes(0), done(false), corrupt(false)
+	{
+		reader = thread(&SectionPipeline::mRun, this);
+	}
+
+	~SectionPipeline() {
+		/* Drain so that the reader is not left blocked on a full queue */
+		Section sec("", Slice(slice_str_t(), string()));
+		try {
+			while (Pop(&sec)) {}
+		} catch (ExcChecksum &) {}
+		reader.join();
+	}
+
+	bool Pop(Section *oSec) {
+		unique_lock<mutex> lock(mtx);
+		cv.wait(lock, [this]() { return !q.empty() || done; });
+
+		if (q.empty() && corrupt)
+			throw ExcChecksum();
+		if (q.empty())
+			return false;
+
+		*oSec = q.front();
+		q.pop_front();
+		qBytes -= oSec->data.size();
+		cv.notify_all();
+
+		return true;
+	}
+};
+
+/* Work stealing pool: every worker owns a task deque.
+*  Tasks pushed from a worker go on its own deque and are popped LIFO (cache warm, nested work first),
+*  idle workers steal FIFO from the others. Tasks pushed from outside are spread round robin. */
+class ThreadPool {
+	struct WorkQ {
+		mutex mtx;
+		deque<function<void()> > q;
+	};
+
+	vector<thread>              worker;
+	vector<thread::id>          workerId;
+	vector<shared_ptr<WorkQ> >  wq;
+
+	/* Sleeping / wakeup and startup.
+	*  'pushed' counts Push calls; an idle worker sleeps until it moves past the value it saw before its last failed pop */
+	mutex mtx;
+	condition_variable cv;
+	unsigned int pushed;
+	bool started;
+	bool quit;
+
+	atomic<unsigned int> roundRobin;
+
+	ThreadPool(const ThreadPool &other);
+	ThreadPool & operator=(const ThreadPool &other);
+
+	int mSelf() const {
+		thread::id self = this_thread::get_id();
+		for (int i = 0; i < workerId.size(); i++)
+			if (workerId[i] == self)
+				return i;
+		return -1;
+	}
+
+	bool mTryPop(int self, function<void()> *oTask) {
+		{
+			WorkQ &w = *wq[self];
+			unique_lock<mutex> lock(w.mtx);
+			if (!w.q.empty()) {
+				*oTask = w.q.back();
+				w.q.pop_back();
+				return true;
+			}
+		}
+		for (int k = 1; k < wq.size(); k++) {
+			WorkQ &w = *wq[(self + k) % wq.size()];
+			unique_lock<mutex> lock(w.mtx);
+			if (!w.q.empty()) {
+				*oTask = w.q.front();
+				w.q.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void mRun(int self) {
+		{
+			unique_lock<mutex> lock(mtx);
+			cv.wait(lock, [this]() { return started; });
+		}
+
+		function<void()> task;
+		while (true) {
+			unsigned int seen;
+			{
+				unique_lock<mutex> lock(mtx);
+				seen = pushed;
+			}
+
+			if (mTryPop(self, &task)) {
+				task();
+				continue;
+			}
+
+			/* A task pushed after the snapshot bumps 'pushed', so it cannot be missed; one that another worker
+			*  stole in the meantime does not keep this worker spinning */
+			unique_lock<mutex> lock(mtx);
+			cv.wait(lock, [this, seen]() { return quit || pushed != seen; });
+			if (quit && pushed == seen)
+				return;
+		}
+	}
+
+public:
+	/* numThread == 0: one per hardware thread */
+	ThreadPool(int numThread = 0) : pushed(0), started(false), quit(false) {
+		roundRobin = 0;
+
+		if (numThread <= 0)
+			numThread = max(1, (int)thread::hardware_concurrency());
+
+		for (int i = 0; i < numThread; i++)
+			wq.push_back(shared_ptr<WorkQ>(new WorkQ()));
+		for (int i = 0; i < numThread; i++)
+			worker.push_back(thread(&ThreadPool::mRun, this, i));
+
+		/* Workers only start looking at workerId (mSelf) once it is complete */
+		unique_lock<mutex> lock(mtx);
+		for (auto &i : worker)
+			workerId.push_back(i.get_id());
+		started = true;
+		cv.notify_all();
+	}
+
+	/* Runs the remaining queued tasks, then joins */
+	~ThreadPool() {
+		{
+			unique_lock<mutex> lock(mtx);
+			quit = true;
+		}
+		cv.notify_all();
+		for (auto &i : worker)
+			i.join();
+	}
+
+	void Push(const function<void()> &task) {
+		int self = mSelf();
+		int dst  = self != -1 ? self : (int)(roundRobin++ % wq.size());
+
+		{
+			WorkQ &w = *wq[dst];
+			unique_lock<mutex> lock(w.mtx);
+			w.q.push_back(task);
+		}
+
+		unique_lock<mutex> lock(mtx);
+		pushed++;
+		cv.notify_one();
+	}
+
+	int NumThread() const {
+		return worker.size();
+	}
+};
+
+/* Calls fn(0) .. fn(n-1) over the pool, returning once all calls are done. Serial when 'pool' is NULL.
+*  The calling thread takes indices too and only ever waits on calls already running,
+*  so nested use from inside a pool task cannot deadlock.
+*  The first exception thrown by 'fn' is rethrown here once every claimed call has finished; indices not yet started
+*  at that point are skipped. */
+void ParallelFor(ThreadPool *pool, int n, const function<void(int)> &fn) {
+	if (!pool || n <= 1) {
+		for (int i = 0; i < n; i++)
+			fn(i);
+		return;
+	}
+
+	struct State {
+		atomic<int> next;
+		atomic<bool> failed;
+		int n, done;
+		const function<void(int)> *fn;
+		exception_ptr err;
+		mutex mtx;
+		condition_variable cv;
+	};
+
+	shared_ptr<State> st(new State());
+	st->next   = 0;
+	st->failed = false;
+	st->n      = n;
+	st->done = 0;
+	st->fn   = &fn;
+
+	/* Helpers left in the queue after all indices were taken find nothing to do and never touch 'fn'.
+	*  Nothing may escape into the pool (a throwing task terminates its worker), and every index is still
+	*  counted after a failure so that the caller never returns while a call is running. */
+	auto drain = [](const shared_ptr<State> &st) {
+		int i;
+		while ((i = st->next++) < st->n) {
+			if (!st->failed) {
+				try {
+					(*st->fn)(i);
+				} catch (...) {
+					unique_lock<mutex> lock(st->mtx);
+					if (!st->err)
+						st->err = current_exception();
+					st->failed = true;
+				}
+			}
+			unique_lock<mutex> lock(st->mtx);
+			if (++st->done == st->n)
+				st->cv.notify_all();
+		}
+	};
+
+	for (int i = 0; i < min(n - 1, pool->NumThread()); i++)
+		pool->Push([st, drain]() { drain(st); });
+
+	drain(st);
+
+	unique_lock<mutex> lock(st->mtx);
+	st->cv.wait(lock, [&st]() { return st->done == st->n; });
+
+	if (st->err)
+		rethrow_exception(st->err);
+}
+
+/* Name -> Section lookup built once per file.
+*  On duplicate names the first Section wins, as with a front to back scan. */
+class SectionIndex {
+	vector<Section> sec;
+	unordered_map<string, int> idx;
+public:
+	void Add(const Section &s) {
+		if (idx.find(s.name) == idx.end()) {
+			idx[s.name] = sec.size();
+			sec.push_back(s);
+		}
+	}
+
+	bool Exist(const string &name) const {
+		return idx.find(name) != idx.end();
+	}
+
+	const Section & Get(const string &name) const {
+		unordered_map<string, int>::const_iterator it = idx.find(name);
+		if (it == idx.end())
+			throw ExcItemExist();
+		return sec[it->second];
+	}
+
+	int size() const {
+		return sec.size();
+	}
+};
+
+void * BuAlignedMalloc(size_t size, size_t align) {
+#ifdef _WIN32
+	void *p = _aligned_malloc(size, align);
+#else
+	void *p = NULL;
+	if (posix_memalign(&p, align, size) != 0)
+		p = NULL;
+#endif
+	assert(p);
+	return p;
+}
+
+void BuAlignedFree(void *p) {
+#ifdef _WIN32
+	_aligned_free(p);
+#else
+	free(p);
+#endif
+}
+
+/* Monotonic allocator: hands out memory from large blocks and frees everything at once on Release / destruction.
+*  Used to give all the allocations of one asset a common lifetime (See Parse::MakeSectionDataPacked). */
+class Arena {
+	vector<char *> block;
+	size_t blockSize;
+	char  *cur;
+	size_t left;
+	size_t used;
+
+	Arena(const Arena &other);
+	Arena & operator=(const Arena &other);
+public:
+	enum { BlockAlign = 16 };
+
+	Arena(size_t blockSize = 1024 * 1024) : blockSize(max(blockSize, (size_t)BlockAlign)), cur(NULL), left(0), used(0) {}
+
+	~Arena() {
+		Release();
+	}
+
+	void * Alloc(size_t size, size_t align = BlockAlign) {
+		assert(align && align <= BlockAlign && (BlockAlign % align) == 0);
+
+		size_t pad = cur ? (align - ((size_t)cur % align)) % align : 0;
+
+		if (!cur || pad + size > left) {
+			/* Oversized requests get a block of their own, the current block stays in use */
+			if (size > blockSize / 4) {
+				char *b = (char *)BuAlignedMalloc(max(size, (size_t)1), BlockAlign);
+				block.push_back(b);
+				used += size;
+				return b;
+			}
+			cur  = (char *)BuAlignedMalloc(blockSize, BlockAlign);
+			left = blockSize;
+			pad  = 0;
+			block.push_back(cur);
+		}
+
+		char *r = cur + pad;
+		cur  += pad + size;
+		left -= pad + size;
+		used += size;
+
+		return r;
+	}
+
+	/* Makes the next 'size' bytes of (BlockAlign multiple) requests come from a single block: opens one of
+	*  exactly that size unless the current block still has room. Lets a caller that knows its totals up front
+	*  pay for no slack. */
+	void Reserve(size_t size) {
+		size_t pad = cur ? (BlockAlign - ((size_t)cur % BlockAlign)) % BlockAlign : 0;
+
+		if (cur && pad + size <= left)
+			return;
+
+		left = max(size, (size_t)BlockAlign);
+		cur  = (char *)BuAlignedMalloc(left, BlockAlign);
+		block.push_back(cur);
+	}
+
+	void Release() {
+		for (auto &i : block)
+			BuAlignedFree(i);
+		block.clear();
+		cur  = NULL;
+		left = 0;
+		used = 0;
+	}
+
+	size_t BytesUsed() const {
+		return used;
+	}
+};
+
+/* STL allocator drawing from an Arena (deallocate is a no-op, memory returns on Arena::Release).
+*  A NULL Arena falls back to the global heap. */
+template<typename T>
+class ArenaAllocator {
+public:
+	typedef T         value_type;
+	typedef T *       pointer;
+	typedef const T * const_pointer;
+	typedef T &       reference;
+	typedef const T & const_reference;
+	typedef size_t    size_type;
+	typedef ptrdiff_t difference_type;
+
+	template<typename U> struct rebind { typedef ArenaAllocator<U> other; };
+
+	Arena *arena;
+
+	ArenaAllocator(Arena *arena = NULL) : arena(arena) {}
+	template<typename U> ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+	pointer allocate(size_type n, const void * = NULL) {
+		if (!arena)
+			return (pointer)::operator new(n * sizeof(T));
+		/* Lowest set bit of sizeof(T) is a multiple of T's alignment */
+		return (pointer)arena->Alloc(n * sizeof(T), min(sizeof(T) & (~sizeof(T) + 1), (size_t)Arena::BlockAlign));
+	}
+
+	void deallocate(pointer p, size_type n) {
+		if (!arena)
+			::operator delete(p);
+	}
+
+	void construct(pointer p, const T &v) { new ((void *)p) T(v); }
+	void destroy(pointer p) { p->~T(); }
+
+	size_type max_size() const { return ((size_type)-1) / sizeof(T); }
+
+	pointer address(reference x) const { return &x; }
+	const_pointer address(const_reference x) const { return &x; }
+
+	template<typename U> bool operator==(const ArenaAllocator<U> &other) const { return arena == other.arena; }
+	template<typename U> bool operator!=(const ArenaAllocator<U> &other) const { return arena != other.arena; }
+};
+
+/* One attribute of all Meshes in a single 16 byte aligned allocation.
+*  Part 'i' (usually a Mesh) starts at Ptr(i) and holds Count(i) elements; part starts are 16 byte aligned too.
+*  Padding between parts is zero filled. T must be a 4 byte POD type (int, float). */
+template<typename T>
+class PackedAttr {
+	shared_ptr<T> buf;
+	int total;
+	vector<int> offset;
+	vector<int> count;
+public:
+	static const int AlignBytes = 16;
+
+	PackedAttr() : total(0) {}
+
+	/* Size of the buffer Alloc(partCount) makes, a multiple of AlignBytes */
+	static size_t Bytes(const vector<int> &partCount) {
+		const int alignElt = AlignBytes / sizeof(T);
+		int n = 0;
+
+		for (auto &i : partCount)
+			n += (i + alignElt - 1) / alignElt * alignElt;
+
+		return max(n, alignElt) * sizeof(T);
+	}
+
+	/* With an Arena the buffer is carved out of it and keeps the Arena alive */
+	void Alloc(const vector<int> &partCount, const shared_ptr<Arena> &arena = shared_ptr<Arena>()) {
+		const int alignElt = AlignBytes / sizeof(T);
+		assert(AlignBytes % sizeof(T) == 0);
+
+		offset.resize(partCount.size());
+		count = partCount;
+		total = 0;
+		for (int i = 0; i < partCount.size(); i++) {
+			assert(partCount[i] >= 0);
+			offset[i] = total;
+			total += (partCount[i] + alignElt - 1) / alignElt * alignElt;
+		}
+
+		/* Allocate at least one aligned block so that Ptr() is never NULL */
+		size_t bytes = max(total, alignElt) * sizeof(T);
+		if (arena)
+			buf = shared_ptr<T>(arena, (T *)arena->Alloc(bytes, AlignBytes));
+		else
+			buf = shared_ptr<T>((T *)BuAlignedMalloc(bytes, AlignBytes), BuAlignedFree);
+		memset(buf.get(), 0, bytes);
+	}
+
+	int NumPart() const {
+		return count.size();
+	}
+
+	int Count(int part) const {
+		return count[part];
+	}
+
+	int Offset(int part) const {
+		return offset[part];
+	}
+
+	T * Ptr(int part) {
+		return buf.get() + offset[part];
+	}
+
+	const T * Ptr(int part) const {
+		return buf.get() + offset[part];
+	}
+
+	/* Whole buffer including padding, 'Size' elements */
+	const T * Data() const {
+		return buf.get();
+	}
+
+	int Size() const {
+		return total;
+	}
+};
+
+enum AnimTrackKind { AnimLoc, AnimRot, AnimScale, AnimTrackCount };
+
+/* One location, rotation or scale track of an AnimChannel. numKey 0: the identity default, 1: a constant,
+*  more: keys at AnimClip::time[timeOff ..] (ascending seconds), interpolated linearly (nlerp for rotation).
+*  Values start at valOff in AnimClip::vec (location, scale: 3 floats per key) or AnimClip::rot (3 uint16_t per key,
+*  See QuatSmallest3Decode). */
+struct AnimTrack {
+	int numKey;
+	int timeOff;
+	int valOff;
+};
+
+/* Keyframes of one bone within a clip. Reduced tracks are kept as the exporter packed them and decoded per sample
+*  (See AnimSampler); an uncompressed channel instead keeps whole DTrs keys, lossless and sampled in one step. */
+struct AnimChannel {
+	int bone;
+	/* Uncompressed: track[AnimLoc].numKey keys at AnimClip::key[keyOff ..], keyed at that track's times (all three
+	*  tracks carry the same numKey and timeOff, valOff is unused). -1 for reduced tracks. */
+	int keyOff;
+	AnimTrack track[AnimTrackCount];
+};
+
+/* Channels index into the pools of their clip, so that sampling a clip walks a few small contiguous arrays */
+struct AnimClip {
+	string name;
+	float  duration;
+	vector<AnimChannel> channel;
+	vector<float>    time;
+	vector<float>    vec;
+	vector<uint16_t> rot;
+	vector<DTrs>     key;
+
+	size_t KeyBytes() const {
+		return channel.size() * sizeof(AnimChannel) + (time.size() + vec.size()) * sizeof(float) + rot.size() * sizeof(uint16_t) +
+			key.size() * sizeof(DTrs);
+	}
+};
+
+/* Appends a channel keyed at all 'numKey' times (ascending seconds).
+*  The uncompressed ANIMCHANTIME / ANIMCHANTRS form, stored as it is (See AnimChannel::keyOff). */
+void AnimClipAddChannel(AnimClip *clip, int bone, const float *time, const DTrs *key, int numKey) {
+	assert(numKey >= 1);
+
+	AnimChannel ch;
+	ch.bone   = bone;
+	ch.keyOff = clip->key.size();
+
+	int timeOff = clip->time.size();
+	if (numKey > 1)
+		clip->time.insert(clip->time.end(), time, time + numKey);
+	clip->key.insert(clip->key.end(), key, key + numKey);
+
+	for (int j = 0; j < AnimTrackCount; j++) {
+		AnimTrack &tr = ch.track[j];
+		tr.numKey  = numKey;
+		tr.timeOff = timeOff;
+		tr.valOff  = 0;
+	}
+
+	clip->duration = max(clip->duration, time[numKey - 1]);
+	clip->channel.push_back(ch);
+}
+
+/* Everything but the per-vertex geometry */
+class SectionDataHier {
+public:
+	vector<string> meshName;
+	vector<int>    meshParent;
+	vector<DMat>   meshMatrix;
+
+	vector<string> boneName;
+	vector<int>    boneParent;
+	vector<DMat>   boneMatrix;
+	/* Inverse of boneMatrix (the bind pose), from BONEINVBIND when present, computed once at load otherwise */
+	vector<DMat>   boneInvBind;
+
+	vector<vector<int> > meshChild;
+	vector<vector<int> > boneChild;
+
+	/* Parent-before-child orderings (See HierarchyValidate) */
+	vector<int> meshTopo;
+	vector<int> boneTopo;
+
+	/* Rest pose of each bone relative to its parent: boneInvBind[parent] * boneMatrix (boneMatrix for roots) */
+	vector<DMat> boneRestLocal;
+
+	/* From the optional ANIM* sections, empty when the file has none */
+	vector<AnimClip> anim;
+};
+
+class SectionData : public SectionDataHier {
+public:
+	vector<vector<float> > meshVert;
+	vector<vector<int> >   meshIndex;
+
+	/* [Mesh0: [Vert0: id*BU_MAX_INFLUENCING_BONE ...] ...] */
+	vector<vector<int> >   meshVertId;
+	vector<vector<float> > meshVertWt;
+};
+
+class SectionDataEx : public SectionData {
+public:
+};
+
+/* Content of SectionData with the meshes welded (See Parse::FillSectionDataPacked) and the geometry laid out as one
+*  contiguous array per attribute (Parts are Meshes). */
+class SectionDataPacked : public SectionDataHier {
+public:
+	PackedAttr<float> meshVert;
+	PackedAttr<int>   meshIndex;
+
+	PackedAttr<int>   meshVertId;
+	PackedAttr<float> meshVertWt;
+};
+
+/* IEEE 754 binary16, round to nearest even. Overflow goes to infinity, NaN stays NaN. */
+inline uint16_t FloatToHalf(float f) {
+	uint32_t x;
+	memcpy(&x, &f, 4);
+
+	uint32_t sign = (x >> 16) & 0x8000;
+	uint32_t ax   = x & 0x7FFFFFFF;
+
+	if (ax >= 0x7F800000)
+		return sign | 0x7C00 | (ax > 0x7F800000 ? 0x200 : 0);
+	/* 65520 and up round to infinity */
+	if (ax >= 0x477FF000)
+		return sign | 0x7C00;
+	/* Half subnormals (below 2^-14), in units of 2^-24 */
+	if (ax < 0x38800000) {
+		int e = ax >> 23;
+		if (e < 102)
+			return sign;
+		uint32_t mant  = (ax & 0x7FFFFF) | 0x800000;
+		int      shift = 126 - e;
+		uint32_t r     = mant >> shift;
+		uint32_t rem   = mant & ((1u << shift) - 1);
+		uint32_t half  = 1u << (shift - 1);
+		if (rem > half || (rem == half && (r & 1)))
+			r++;
+		return sign | r;
+	}
+
+	/* Rebias the exponent (127 - 15), round the dropped 13 mantissa bits */
+	uint32_t r = ax - 0x38000000;
+	r += 0xFFF + ((r >> 13) & 1);
+	return sign | (r >> 13);
+}
+
+inline float HalfToFloat(uint16_t h) {
+	uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+	uint32_t exp  = (h >> 10) & 0x1F;
+	uint32_t mant = h & 0x3FF;
+	uint32_t x;
+
+	if (exp == 0) {
+		float f = mant * (1.0f / 16777216.0f);
+		return sign ? -f : f;
+	}
+	if (exp == 31)
+		x = sign | 0x7F800000 | (mant << 13);
+	else
+		x = sign | ((exp + 112) << 23) | (mant << 13);
+
+	float f;
+	memcpy(&f, &x, 4);
+	return f;
+}
+
+/* Compact vertex streams of one mesh (See MeshVertQ::Make): 8 bit bone ids, 8 or 16 bit unorm weights, and positions kept
+*  as floats, as half floats or as 16 bit unorm within the mesh bounds. From 44 bytes per vertex down to 16 (Unorm16 / Unorm8).
+*  The quantised weights of a vertex sum to exactly 255 (65535), or are all zero where the float weights were (meshMat fallback). */
+class MeshVertQ {
+public:
+	enum PosFormat { PosFloat, PosHalf, PosUnorm16 };
+	enum WtFormat  { WtUnorm8, WtUnorm16 };
+
+	PosFormat posFormat;
+	WtFormat  wtFormat;
+	int       numVert;
+
+	/* Position = posMin + posScale * q per axis for PosUnorm16 (0 and 1 for the other formats) */
+	float posMin[3];
+	float posScale[3];
+
+	/* PosFloat: xyz floats. PosHalf, PosUnorm16: 4 shorts per vertex, the fourth zero (keeps vertex attributes 8 byte aligned) */
+	vector<float>    posF;
+	vector<uint16_t> posQ;
+
+	/* BU_MAX_INFLUENCING_BONE per vertex, only one of wt8 / wt16 is filled */
+	vector<uint8_t>  id;
+	vector<uint8_t>  wt8;
+	vector<uint16_t> wt16;
+
+	MeshVertQ() : posFormat(PosFloat), wtFormat(WtUnorm8), numVert(0) {}
+
+	/* Largest remainder rounding: the float weights scaled to 'unit' are floored, the shortfall goes to the largest fractions */
+	static void QuantizeWeight(const float *wt, int unit, int *oQ) {
+		const int K = BU_MAX_INFLUENCING_BONE;
+		float sum = 0.0f, wsq = 0.0f;
+
+		for (int k = 0; k < K; k++) {
+			sum += max(wt[k], 0.0f);
+			wsq += wt[k] * wt[k];
+		}
+
+		/* Same test as SkinLbsOne, so that unweighted vertices stay unweighted */
+		if (wsq < 0.001f * 0.001f || sum <= 0.0f) {
+			for (int k = 0; k < K; k++)
+				oQ[k] = 0;
+			return;
+		}
+
+		float frac[K];
+		int   total = 0;
+		for (int k = 0; k < K; k++) {
+			float f = max(wt[k], 0.0f) / sum * unit;
+			oQ[k]   = min((int)f, unit);
+			frac[k] = f - oQ[k];
+			total  += oQ[k];
+		}
+		for (; total < unit; total++) {
+			int best = 0;
+			for (int k = 1; k < K; k++)
+				if (frac[k] > frac[best])
+					best = k;
+			oQ[best]++;
+			frac[best] = -1.0f;
+		}
+		assert(total == unit);
+	}
+
+	static void Make(const float *vert, const int *vertId, const float *vertWt, int numVert, PosFormat posFormat, WtFormat wtFormat, MeshVertQ *o) {
+		const int K = BU_MAX_INFLUENCING_BONE;
+
+		o->posFormat = posFormat;
+		o->wtFormat  = wtFormat;
+		o->numVert   = numVert;
+		o->posF.clear();
+		o->posQ.clear();
+		o->wt8.clear();
+		o->wt16.clear();
+
+		for (int j = 0; j < 3; j++) {
+			o->posMin[j]   = 0.0f;
+			o->posScale[j] = 1.0f;
+		}
+
+		if (posFormat == PosFloat) {
+			o->posF.assign(vert, vert + 3 * numVert);
+		} else if (posFormat == PosHalf) {
+			o->posQ.resize(4 * numVert);
+			for (int v = 0; v < numVert; v++)
+				for (int j = 0; j < 3; j++)
+					o->posQ[4 * v + j] = FloatToHalf(vert[3 * v + j]);
+		} else {
+			float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+			for (int v = 0; v < numVert; v++)
+				for (int j = 0; j < 3; j++) {
+					lo[j] = min(lo[j], vert[3 * v + j]);
+					hi[j] = max(hi[j], vert[3 * v + j]);
+				}
+			for (int j = 0; j < 3; j++) {
+				o->posMin[j]   = numVert ? lo[j] : 0.0f;
+				o->posScale[j] = numVert ? (hi[j] - lo[j]) / 65535.0f : 0.0f;
+			}
+			o->posQ.resize(4 * numVert);
+			for (int v = 0; v < numVert; v++)
+				for (int j = 0; j < 3; j++) {
+					float q = o->posScale[j] > 0.0f ? (vert[3 * v + j] - o->posMin[j]) / o->posScale[j] : 0.0f;
+					o->posQ[4 * v + j] = (uint16_t)min(max((int)(q + 0.5f), 0), 65535);
+				}
+		}
+
+		o->id.resize(K * numVert);
+		for (int i = 0; i < K * numVert; i++) {
+			assert(vertId[i] >= 0 && vertId[i] < 256);
+			o->id[i] = (uint8_t)vertId[i];
+		}
+
+		int unit = wtFormat == WtUnorm8 ? 255 : 65535;
+		if (wtFormat == WtUnorm8)
+			o->wt8.resize(K * numVert);
+		else
+			o->wt16.resize(K * numVert);
+		for (int v = 0; v < numVert; v++) {
+			int q[K];
+			QuantizeWeight(vertWt + K * v, unit, q);
+			for (int k = 0; k < K; k++) {
+				if (wtFormat == WtUnorm8)
+					o->wt8[K * v + k] = (uint8_t)q[k];
+				else
+					o->wt16[K * v + k] = (uint16_t)q[k];
+			}
+		}
+	}
+
+	/* Vertices [beg, beg + n) back to the float layout of SkinLbs. oVert must have room for one float past 3 * n. */
+	void Decode(int beg, int n, float *oVert, int *oId, float *oWt) const {
+		const int K = BU_MAX_INFLUENCING_BONE;
+
+		assert(beg >= 0 && beg + n <= numVert);
+
+#ifdef BU_DMAT_SSE2
+		/* One vertex per iteration: the 4 shorts, 4 ids and 4 weights each widen to a register.
+		*  Positions are stored 4 wide, the spare lane is overwritten by the next vertex (hence the extra float). */
+		if (posFormat == PosUnorm16 && wtFormat == WtUnorm8 && K == 4) {
+			const __m128i zero  = _mm_setzero_si128();
+			const __m128  pMin  = _mm_setr_ps(posMin[0], posMin[1], posMin[2], 0.0f);
+			const __m128  pSc   = _mm_setr_ps(posScale[0], posScale[1], posScale[2], 0.0f);
+			const __m128  wSc   = _mm_set1_ps(1.0f / 255.0f);
+			for (int i = 0; i < n; i++) {
+				int v = beg + i;
+				__m128i p = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)&posQ[4 * v]), zero);
+				_mm_storeu_ps(oVert + 3 * i, _mm_add_ps(pMin, _mm_mul_ps(pSc, _mm_cvtepi32_ps(p))));
+
+				int32_t ib, wb;
+				memcpy(&ib, &id[4 * v], 4);
+				memcpy(&wb, &wt8[4 * v], 4);
+				__m128i i4 = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(ib), zero), zero);
+				__m128i w4 = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(wb), zero), zero);
+				_mm_storeu_si128((__m128i *)(oId + 4 * i), i4);
+				_mm_storeu_ps(oWt + 4 * i, _mm_mul_ps(wSc, _mm_cvtepi32_ps(w4)));
+			}
+			return;
+		}
+#endif
+
+		if (posFormat == PosFloat) {
+			memcpy(oVert, &posF[3 * beg], 3 * n * sizeof(float));
+		} else if (posFormat == PosHalf) {
+			for (int i = 0; i < n; i++)
+				for (int j = 0; j < 3; j++)
+					oVert[3 * i + j] = HalfToFloat(posQ[4 * (beg + i) + j]);
+		} else {
+			for (int i = 0; i < n; i++)
+				for (int j = 0; j < 3; j++)
+					oVert[3 * i + j] = posMin[j] + posScale[j] * posQ[4 * (beg + i) + j];
+		}
+
+		for (int i = 0; i < K * n; i++)
+			oId[i] = id[K * beg + i];
+
+		if (wtFormat == WtUnorm8) {
+			for (int i = 0; i < K * n; i++)
+				oWt[i] = wt8[K * beg + i] * (1.0f / 255.0f);
+		} else {
+			for (int i = 0; i < K * n; i++)
+				oWt[i] = wt16[K * beg + i] * (1.0f / 65535.0f);
+		}
+	}
+
+	int Bytes() const {
+		return posF.size() * sizeof(float) + posQ.size() * sizeof(uint16_t) + id.size() + wt8.size() + wt16.size() * sizeof(uint16_t);
+	}
+};
+
+#define BU_BAKED_VERSION 1
+static const char BU_BAKED_MAGIC[4] = { 'B', 'U', 'B', 'K' };
+
+/* Read-only view of a baked image (See BakeSectionData): the processed SectionDataEx as flat arrays in the baking
+*  host's native layout, each 16 byte aligned. Loading maps the file and turns the offsets of the Header into the
+*  pointers below; nothing is decoded or copied, pages come in as the arrays are first touched.
+*  Child lists and names are CSR: the entries of node 'i' are [beg[i], beg[i+1]). Animation is not baked. */
+class SectionDataBaked {
+public:
+	enum Kind {
+		MeshNameBeg, MeshNameChar, MeshParent, MeshMatrix, MeshChildBeg, MeshChild, MeshTopo,
+		BoneNameBeg, BoneNameChar, BoneParent, BoneMatrix, BoneInvBind, BoneRestLocal, BoneChildBeg, BoneChild, BoneTopo,
+		MeshPart, MeshVert, MeshIndex, MeshVertId, MeshVertWt,
+		KindCount
+	};
+
+	/* 'count' elements at byte offset 'off' from the start of the image */
+	struct Ref {
+		int off;
+		int count;
+	};
+
+	/* Element offsets and counts of one mesh within the MeshVert, MeshIndex and MeshVertId/MeshVertWt arrays */
+	struct Part {
+		int vertOff,   vertCount;
+		int indexOff,  indexCount;
+		int weightOff, weightCount;
+	};
+
+	struct Header {
+		char magic[4];
+		int  version;
+		/* 0x01020304 and sizeof(DMat) as seen by the baking host - a mismatch means a rebake, not a conversion */
+		int  byteOrder;
+		int  sizeofMat;
+		int  lenImage;
+		int  numMesh;
+		int  numBone;
+		int  numRef;
+		Ref  ref[KindCount];
+	};
+
+	/* Keeps the mapping alive */
+	Slice image;
+
+	int numMesh;
+	int numBone;
+
+	const int  *meshNameBeg;
+	const char *meshNameChar;
+	const int  *meshParent;
+	const DMat *meshMatrix;
+	const int  *meshChildBeg;
+	const int  *meshChild;
+	const int  *meshTopo;
+
+	const int  *boneNameBeg;
+	const char *boneNameChar;
+	const int  *boneParent;
+	const DMat *boneMatrix;
+	const DMat *boneInvBind;
+	const DMat *boneRestLocal;
+	const int  *boneChildBeg;
+	const int  *boneChild;
+	const int  *boneTopo;
+
+	const Part  *meshPart;
+	const float *meshVert;
+	const int   *meshIndex;
+	const int   *meshVertId;
+	const float *meshVertWt;
+
+	SectionDataBaked(const Slice &image) : image(image) {}
+
+	static int EltSize(Kind k) {
+		switch (k) {
+		case MeshNameChar: case BoneNameChar:
+			return 1;
+		case MeshMatrix: case BoneMatrix: case BoneInvBind: case BoneRestLocal:
+			return sizeof(DMat);
+		case MeshPart:
+			return sizeof(Part);
+		default:
+			return 4;
+		}
+	}
+
+	string MeshName(int mesh) const {
+		return string(meshNameChar + meshNameBeg[mesh], meshNameBeg[mesh + 1] - meshNameBeg[mesh]);
+	}
+
+	string BoneName(int bone) const {
+		return string(boneNameChar + boneNameBeg[bone], boneNameBeg[bone + 1] - boneNameBeg[bone]);
+	}
+
+	int NumVert(int mesh) const {
+		return meshPart[mesh].vertCount / 3;
+	}
+
+	const float * Vert(int mesh) const     { return meshVert   + meshPart[mesh].vertOff; }
+	const int *   Index(int mesh) const    { return meshIndex  + meshPart[mesh].indexOff; }
+	const int *   VertId(int mesh) const   { return meshVertId + meshPart[mesh].weightOff; }
+	const float * VertWt(int mesh) const   { return meshVertWt + meshPart[mesh].weightOff; }
+};
+
+class HierarchyDiag {
+public:
+	enum Kind { Ok, ParentRange, ChildMismatch, ReachedTwice, Unreached };
+
+	Kind kind;
+	/* Offending node, -1 for Ok */
+	int  node;
+
+	HierarchyDiag() : kind(Ok), node(-1) {}
+	HierarchyDiag(Kind kind, int node) : kind(kind), node(node) {}
+
+	bool IsOk() const { return kind == Ok; }
+
+	const char * What() const {
+		switch (kind) {
+		case Ok:            return "ok";
+		case ParentRange:   return "parent index out of range";
+		case ChildMismatch: return "child list disagrees with parent";
+		case ReachedTwice:  return "node reached more than once";
+		case Unreached:     return "node unreachable from any root (cycle)";
+		}
+		return "?";
+	}
+};
+
+/* A MESHPARENT / BONEPARENT hierarchy failing HierarchyValidate at load */
+class ExcHierarchy : public exception {
+public:
+	/* "mesh" or "bone" */
+	const char   *hierarchy;
+	HierarchyDiag diag;
+
+	ExcHierarchy(const char *hierarchy, const HierarchyDiag &diag) : hierarchy(hierarchy), diag(diag) {}
+
+	const char * what() const throw() {
+		return diag.What();
+	}
+};
+
+/* Validates a multi-root hierarchy in one iterative O(n) breadth first pass from the roots (parent -1), checking
+*    - parent indices in range
+*    - child lists consistent with parent
+*    - every node reached, and reached exactly once (an unreached node with in range parents is part of, or hangs off, a cycle)
+*  On success oTopo (if given) receives all nodes in parent-before-child order. */
+HierarchyDiag HierarchyValidate(const vector<int> &parent, const vector<vector<int> > &child, vector<int> *oTopo = NULL) {
+	int n = parent.size();
+
+	if (child.size() != n)
+		return HierarchyDiag(HierarchyDiag::ChildMismatch, -1);
+
+	for (int i = 0; i < n; i++)
+		if (!(parent[i] == -1 || (parent[i] >= 0 && parent[i] < n)))
+			return HierarchyDiag(HierarchyDiag::ParentRange, i);
+
+	vector<int>  topo;
+	vector<char> reached(n, 0);
+	topo.reserve(n);
+
+	for (int i = 0; i < n; i++)
+		if (parent[i] == -1) {
+			reached[i] = 1;
+			topo.push_back(i);
+		}
+
+	/* 'topo' doubles as the BFS queue */
+	for (int q = 0; q < topo.size(); q++) {
+		int v = topo[q];
+		for (auto &c : child[v]) {
+			if (c < 0 || c >= n || parent[c] != v)
+				return HierarchyDiag(HierarchyDiag::ChildMismatch, v);
+			if (reached[c])
+				return HierarchyDiag(HierarchyDiag::ReachedTwice, c);
+			reached[c] = 1;
+			topo.push_back(c);
+		}
+	}
+
+	if (topo.size() != n)
+		return HierarchyDiag(HierarchyDiag::Unreached, find(reached.begin(), reached.end(), 0) - reached.begin());
+
+	if (oTopo)
+		oTopo->swap(topo);
+
+	return HierarchyDiag();
+}
+
+bool MultiRootReachabilityCheck(const vector<vector<int> > &child, const vector<int> &parent) {
+	assert(child.size() == parent.size());
+
+	return HierarchyValidate(parent, child).IsOk();
+}
+
+void MatrixAccumulateWorld(const vector<DMat> &mLocal, const vector<vector<int> > &child, int state, const DMat &mInitial, vector<DMat> *oWorld) {
+	assert(oWorld->size() == mLocal.size());
+
+	/* Iterative preorder walk; a node's world matrix is final before its children are visited */
+	(*oWorld)[state] = DMat::Multiply(mInitial, mLocal[state]);
+
+	vector<int> stack(1, state);
+	while (!stack.empty()) {
+		int v = stack.back();
+		stack.pop_back();
+		for (auto &i : child[v]) {
+			(*oWorld)[i] = DMat::Multiply((*oWorld)[v], mLocal[i]);
+			stack.push_back(i);
+		}
+	}
+}
+
+/* world[i] = world[parent[i]] * local[i] (root[i] * local[i] for roots) in a single sweep over a parent-before-child 'topo' ordering.
+*  'topo' is computed once per hierarchy (SectionDataHier::boneTopo / meshTopo, See HierarchyValidate).
+*  A NULL 'root' stands for identity. oWorld may be mLocal. */
+void MatrixAccumulateWorldTopo(const DMat *mLocal, const int *parent, const int *topo, int n, const DMat *root, DMat *oWorld) {
+	for (int k = 0; k < n; k++) {
+		int i = topo[k];
+		int p = parent[i];
+		oWorld[i] = p != -1 ? DMat::Multiply(oWorld[p], mLocal[i]) : root ? DMat::Multiply(root[i], mLocal[i]) : mLocal[i];
+	}
+}
+
+void MultiRootMatrixAccumulateWorld(const vector<DMat> &mLocal, const vector<int> &parent, const vector<int> &topo, const vector<DMat> &root, vector<DMat> *oWorld) {
+	assert(mLocal.size() == parent.size() && mLocal.size() == topo.size() && mLocal.size() == oWorld->size() && mLocal.size() == root.size());
+
+	if (mLocal.size())
+		MatrixAccumulateWorldTopo(&mLocal[0], &parent[0], &topo[0], mLocal.size(), &root[0], &(*oWorld)[0]);
+}
+
+/* Convenience form validating the hierarchy and computing the ordering on every call - prefer the 'topo' overload per frame */
+void MultiRootMatrixAccumulateWorld(const vector<DMat> &mLocal, const vector<vector<int> > &child, const vector<int> &parent, const vector<DMat> &root, vector<DMat> *oWorld) {
+	assert(mLocal.size() == child.size() && mLocal.size() == parent.size() && mLocal.size() == oWorld->size());
+
+	vector<int> topo;
+	HierarchyDiag diag = HierarchyValidate(parent, child, &topo);
+	assert(diag.IsOk());
+
+	MultiRootMatrixAccumulateWorld(mLocal, parent, topo, root, oWorld);
+}
+
+/* oMeshToBone[m * numBone + b] = meshWorldMatrix[m] * boneInvBind[b], into caller storage of numMesh * numBone */
+void MatrixMeshToBone(const DMat *meshWorldMatrix, int numMesh, const DMat *boneInvBind, int numBone, DMat *oMeshToBone) {
+	for (int m = 0; m < numMesh; m++)
+		for (int b = 0; b < numBone; b++)
+			oMeshToBone[m * numBone + b] = DMat::Multiply(meshWorldMatrix[m], boneInvBind[b]);
+}
+
+void MatrixMeshToBone(const vector<DMat> &meshWorldMatrix, const vector<DMat> &boneInvBind, vector<DMat> *oMeshToBone) {
+	oMeshToBone->resize(meshWorldMatrix.size() * boneInvBind.size());
+	if (oMeshToBone->size())
+		MatrixMeshToBone(&meshWorldMatrix[0], meshWorldMatrix.size(), &boneInvBind[0], boneInvBind.size(), &(*oMeshToBone)[0]);
+}
+
+/* Legacy form taking bone world matrices; inverts each bone once rather than once per mesh */
+void MatrixMeshToBone(const vector<DMat> &meshWorldMatrix, const vector<DMat> &boneWorldMatrix, vector<vector<DMat> > *oWorld) {
+	int numMesh = meshWorldMatrix.size();
+	int numAllBone = boneWorldMatrix.size();
+
+	vector<DMat> boneInvBind(numAllBone);
+	for (int b = 0; b < numAllBone; b++)
+		boneInvBind[b] = DMat::InvertNs(boneWorldMatrix[b]);
+
+	vector<DMat> flat;
+	MatrixMeshToBone(meshWorldMatrix, boneInvBind, &flat);
+
+	oWorld->resize(numMesh);
+	for (int m = 0; m < numMesh; m++)
+		(*oWorld)[m].assign(flat.begin() + m * numAllBone, flat.begin() + (m + 1) * numAllBone);
+}
+
+/* Evaluates a clip for all bones at a time t, decoding the two keys around t of each track straight from the clip pools.
+*  Keeps one key cursor per track (per channel for an uncompressed one): playback advancing monotonically steps each cursor forward from where it was,
+*  without a binary search; a backwards jump (loop, seek) restarts the cursors from the first key. */
+class AnimSampler {
+	const AnimClip *clip;
+	/* AnimTrackCount per channel */
+	vector<int> cursor;
+	float lastTime;
+public:
+	enum Interp { Nlerp, Slerp };
+
+	AnimSampler(const AnimClip &clip) :
+		clip(&clip),
+		cursor(AnimTrackCount * clip.channel.size(), 0),
+		lastTime(-FLT_MAX) {}
+
+	/* oPose[numBone]: bones without a channel in the clip get the identity pose. Times outside the keys clamp. */
+	void Sample(float t, int numBone, DTrs *oPose, Interp interp = Nlerp) {
+		if (t < lastTime)
+			fill(cursor.begin(), cursor.end(), 0);
+		lastTime = t;
+
+		for (int b = 0; b < numBone; b++)
+			oPose[b] = DTrs::MakeIdentity();
+
+		for (int c = 0; c < clip->channel.size(); c++) {
+			const AnimChannel &ch = clip->channel[c];
+			DTrs &o = oPose[ch.bone];
+
+			if (ch.keyOff >= 0) {
+				int n = ch.track[AnimLoc].numKey;
+				int &k = cursor[AnimTrackCount * c];
+				const float *time = n > 1 ? &clip->time[ch.track[AnimLoc].timeOff] : NULL;
+				const DTrs  *key  = &clip->key[ch.keyOff];
+
+				while (k + 1 < n && time[k + 1] <= t)
+					k++;
+
+				if (k + 1 >= n || t <= time[k]) {
+					o = key[k];
+					continue;
+				}
+
+				const DTrs &a = key[k];
+				const DTrs &b = key[k + 1];
+				float f = (t - time[k]) / (time[k + 1] - time[k]);
+				Vec4Lerp(a.t, b.t, f, o.t);
+				Vec4Lerp(a.s, b.s, f, o.s);
+				if (interp == Slerp)
+					QuatSlerp(a.r, b.r, f, o.r);
+				else
+					QuatNlerp(a.r, b.r, f, o.r);
+				continue;
+			}
+
+			for (int j = 0; j < AnimTrackCount; j++) {
+				const AnimTrack &tr = ch.track[j];
+				int n = tr.numKey;
+				int &k = cursor[AnimTrackCount * c + j];
+
+				if (!n)
+					continue;
+
+				const float *time = n > 1 ? &clip->time[tr.timeOff] : NULL;
+				while (k + 1 < n && time[k + 1] <= t)
+					k++;
+
+				bool clamp = k + 1 >= n || t <= time[k];
+				float f = clamp ? 0.0f : (t - time[k]) / (time[k + 1] - time[k]);
+
+				if (j == AnimRot) {
+					const uint16_t *v = &clip->rot[tr.valOff + 3 * k];
+#ifdef BU_DMAT_SSE2
+					__m128 qa = QuatSmallest3DecodeSse2(v);
+					if (clamp || interp == Nlerp) {
+						_mm_storeu_ps(o.r, clamp ? qa : QuatNlerpSse2(qa, QuatSmallest3DecodeSse2(v + 3), f));
+						continue;
+					}
+					float a[4], b[4];
+					_mm_storeu_ps(a, qa);
+					_mm_storeu_ps(b, QuatSmallest3DecodeSse2(v + 3));
+					QuatSlerp(a, b, f, o.r);
+#else
+					float a[4], b[4];
+					if (clamp) {
+						QuatSmallest3Decode(v, o.r);
+						continue;
+					}
+					QuatSmallest3Decode(v, a);
+					QuatSmallest3Decode(v + 3, b);
+					if (interp == Slerp)
+						QuatSlerp(a, b, f, o.r);
+					else
+						QuatNlerp(a, b, f, o.r);
+#endif
+				} else {
+					const float *v = &clip->vec[tr.valOff + 3 * k];
+					float *d = j == AnimLoc ? o.t : o.s;
+					for (int i = 0; i < 3; i++)
+						d[i] = clamp ? v[i] : v[i] + (v[i + 3] - v[i]) * f;
+				}
+			}
+		}
+	}
+};
+
+/* Bone world matrices of a local pose: world[b] = world[parent] * boneRestLocal[b] * pose[b] */
+void AnimPoseToWorld(const SectionDataHier &sd, const DTrs *pose, DMat *oWorld) {
+	int numBone = sd.boneName.size();
+
+	for (int b = 0; b < numBone; b++)
+		oWorld[b] = DMat::Multiply(sd.boneRestLocal[b], pose[b].ToMat());
+
+	if (numBone)
+		MatrixAccumulateWorldTopo(oWorld, &sd.boneParent[0], &sd.boneTopo[0], numBone, NULL, oWorld);
+}
+
+/* q = a * b, components (x, y, z, w) */
+inline void QuatMul(const float *a, const float *b, float *o) {
+	float x = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+	float y = a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0];
+	float z = a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3];
+	float w = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+	o[0] = x; o[1] = y; o[2] = z; o[3] = w;
+}
+
+/* Fixed set of numBuffer local pose buffers of numBone bones each, handed out by index.
+*  Sized once (See PoseBlendTree::NumBuffer) so that evaluation never allocates. Not thread-safe: one pool per thread or range. */
+class PosePool {
+	int numBone;
+	vector<DTrs> buf;
+	vector<int>  freeList;
+public:
+	PosePool(int numBone = 0, int numBuffer = 0) :
+		numBone(numBone),
+		buf(numBone * numBuffer) {
+		for (int i = numBuffer - 1; i >= 0; i--)
+			freeList.push_back(i);
+	}
+
+	int Acquire() {
+		assert(!freeList.empty());
+		int i = freeList.back();
+		freeList.pop_back();
+		return i;
+	}
+
+	void Release(int i) {
+		freeList.push_back(i);
+	}
+
+	DTrs * Ptr(int i) {
+		return &buf[i * numBone];
+	}
+
+	int NumBone() const {
+		return numBone;
+	}
+
+	int NumFree() const {
+		return freeList.size();
+	}
+};
+
+/* Blend tree over the clips of a SectionDataHier, shared by every character using it.
+*  Nodes are added children first and the last node added is the root. Masks hold one weight in [0, 1] per bone.
+*  Every node but the root feeds exactly one parent (PoseBlendInstance::Evaluate releases a child's buffer once used);
+*  to reuse a clip, add it again. */
+class PoseBlendTree {
+public:
+	enum Kind { Clip, Blend, Additive };
+
+	struct Node {
+		Kind kind;
+		int  clip;
+		int  a, b;
+		int  mask;
+	};
+
+	vector<Node> node;
+	vector<vector<float> > mask;
+private:
+	vector<char> hasParent;
+
+	int mAddInner(Kind kind, int a, int b, int mask) {
+		assert(a >= 0 && a < node.size() && b >= 0 && b < node.size() && a != b);
+		assert(!hasParent[a] && !hasParent[b]);
+		hasParent[a] = hasParent[b] = 1;
+		Node n = { kind, -1, a, b, mask };
+		return (node.push_back(n), hasParent.push_back(0), node.size() - 1);
+	}
+public:
+	int AddClip(int clip) {
+		Node n = { Clip, clip, -1, -1, -1 };
+		return (node.push_back(n), hasParent.push_back(0), node.size() - 1);
+	}
+
+	/* Lerp/nlerp from a to b by the node weight, scaled per bone by the mask (-1 for none) */
+	int AddBlend(int a, int b, int mask = -1) {
+		return mAddInner(Blend, a, b, mask);
+	}
+
+	/* Layers b on top of a: b is a delta from the identity pose (translation added, rotation and scale multiplied),
+	*  faded in by the node weight and mask */
+	int AddAdditive(int a, int b, int mask = -1) {
+		return mAddInner(Additive, a, b, mask);
+	}
+
+	/* A single tree: only the last node added lacks a parent */
+	bool IsComplete() const {
+		for (int i = 0; i < node.size(); i++)
+			if (!hasParent[i] != (i == node.size() - 1))
+				return false;
+		return !node.empty();
+	}
+
+	int AddMask(const vector<float> &m) {
+		return (mask.push_back(m), mask.size() - 1);
+	}
+
+	/* Pose buffers live at once during evaluation, at most one per node */
+	int NumBuffer() const {
+		return node.size();
+	}
+};
+
+/* Per-character state of a PoseBlendTree: a sampler and time per clip node, a weight per blend node */
+class PoseBlendInstance {
+	const PoseBlendTree *tree;
+	const SectionDataHier *sd;
+	vector<AnimSampler> sampler;
+	vector<int> samplerOf;
+	vector<int> result;
+public:
+	vector<float> time;
+	vector<float> weight;
+
+	PoseBlendInstance(const PoseBlendTree &tree, const SectionDataHier &sd) :
+		tree(&tree),
+		sd(&sd),
+		samplerOf(tree.node.size(), -1),
+		result(tree.node.size(), -1),
+		time(tree.node.size(), 0.0f),
+		weight(tree.node.size(), 0.0f) {
+		for (int i = 0; i < tree.node.size(); i++)
+			if (tree.node[i].kind == PoseBlendTree::Clip) {
+				samplerOf[i] = sampler.size();
+				sampler.push_back(AnimSampler(sd.anim[tree.node[i].clip]));
+			}
+	}
+
+	int NumBuffer() const {
+		return tree->NumBuffer();
+	}
+
+	/* Writes the root pose to oPose[numBone], taking intermediate buffers from pool */
+	void Evaluate(PosePool *pool, DTrs *oPose) {
+		int numBone = sd->boneName.size();
+		int numNode = tree->node.size();
+		assert(pool->NumBone() == numBone && tree->IsComplete());
+
+		for (int i = 0; i < numNode; i++) {
+			const PoseBlendTree::Node &n = tree->node[i];
+			int r = result[i] = pool->Acquire();
+			DTrs *o = pool->Ptr(r);
+
+			if (n.kind == PoseBlendTree::Clip) {
+				sampler[samplerOf[i]].Sample(time[i], numBone, o);
+				continue;
+			}
+
+			const DTrs *pa = pool->Ptr(result[n.a]);
+			const DTrs *pb = pool->Ptr(result[n.b]);
+			const float *m = n.mask == -1 ? NULL : &tree->mask[n.mask][0];
+
+			for (int b = 0; b < numBone; b++) {
+				float w = m ? weight[i] * m[b] : weight[i];
+				if (n.kind == PoseBlendTree::Blend) {
+					Vec4Lerp(pa[b].t, pb[b].t, w, o[b].t);
+					Vec4Lerp(pa[b].s, pb[b].s, w, o[b].s);
+					QuatNlerp(pa[b].r, pb[b].r, w, o[b].r);
+				} else {
+					static const float one[4] = { 1.0f, 1.0f, 1.0f, 0.0f };
+					static const float ident[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+					float s[4], q[4];
+					for (int j = 0; j < 4; j++)
+						o[b].t[j] = pa[b].t[j] + pb[b].t[j] * w;
+					Vec4Lerp(one, pb[b].s, w, s);
+					for (int j = 0; j < 4; j++)
+						o[b].s[j] = pa[b].s[j] * s[j];
+					QuatNlerp(ident, pb[b].r, w, q);
+					QuatMul(pa[b].r, q, o[b].r);
+				}
+			}
+
+			pool->Release(result[n.a]);
+			pool->Release(result[n.b]);
+		}
+
+		memcpy(oPose, pool->Ptr(result[numNode - 1]), numBone * sizeof(DTrs));
+		pool->Release(result[numNode - 1]);
+	}
+};
+
+/* Evaluates n characters into oPose (n * numBone) and, when oWorld is not NULL, their bone world matrices.
+*  All instances share one tree. Characters are split over pool in ranges of 'grain';
+*  range r uses (*posePool)[r], created on the first call. */
+void PoseBlendUpdate(PoseBlendInstance *inst, int n, const SectionDataHier &sd, vector<PosePool> *posePool, DTrs *oPose, DMat *oWorld, ThreadPool *pool = NULL) {
+	const int grain = 64;
+	int numBone = sd.boneName.size();
+	int numRange = (n + grain - 1) / grain;
+
+	if (posePool->size() < numRange)
+		posePool->resize(numRange, PosePool(numBone, n ? inst[0].NumBuffer() : 0));
+
+	ParallelFor(pool, numRange, [&](int r) {
+		for (int i = r * grain; i < min(n, (r + 1) * grain); i++) {
+			inst[i].Evaluate(&(*posePool)[r], oPose + i * numBone);
+			if (oWorld)
+				AnimPoseToWorld(sd, oPose + i * numBone, oWorld + i * numBone);
+		}
+	});
+}
+
+/* Skinned position of one vertex as vsBone computes it: the sum of wt[k] * (boneMat[id[k]] * (p, 1)),
+*  or meshMat * (p, 1) when the weight vector is zero (VecEq4 against zero with delta 0.001). */
+inline void SkinLbsOne(const float *p, const int *id, const float *wt, const DMat *boneMat, const DMat &meshMat, float *o) {
+	float wsq = 0.0f;
+	for (int k = 0; k < BU_MAX_INFLUENCING_BONE; k++)
+		wsq += wt[k] * wt[k];
+
+	if (wsq < 0.001f * 0.001f) {
+		for (int r = 0; r < 3; r++)
+			o[r] = DMAT_ELT(meshMat, r, 0) * p[0] + DMAT_ELT(meshMat, r, 1) * p[1] + DMAT_ELT(meshMat, r, 2) * p[2] + DMAT_ELT(meshMat, r, 3);
+		return;
+	}
+
+	float acc[3] = { 0.0f, 0.0f, 0.0f };
+	for (int k = 0; k < BU_MAX_INFLUENCING_BONE; k++) {
+		const DMat &m = boneMat[id[k]];
+		for (int r = 0; r < 3; r++)
+			acc[r] += wt[k] * (DMAT_ELT(m, r, 0) * p[0] + DMAT_ELT(m, r, 1) * p[1] + DMAT_ELT(m, r, 2) * p[2] + DMAT_ELT(m, r, 3));
+	}
+	o[0] = acc[0]; o[1] = acc[1]; o[2] = acc[2];
+}
+
+/* Skins vertices [beg, end): vert and oVert are xyz triples, vertId and vertWt BU_MAX_INFLUENCING_BONE per vertex */
+typedef void (*SkinLbsFn)(const float *vert, const int *vertId, const float *vertWt, int beg, int end, const DMat *boneMat, const DMat &meshMat, float *oVert);
+
+void SkinLbsScalar(const float *vert, const int *vertId, const float *vertWt, int beg, int end, const DMat *boneMat, const DMat &meshMat, float *oVert) {
+	for (int v = beg; v < end; v++)
+		SkinLbsOne(vert + 3 * v, vertId + BU_MAX_INFLUENCING_BONE * v, vertWt + BU_MAX_INFLUENCING_BONE * v, boneMat, meshMat, oVert + 3 * v);
+}
+
+#ifdef BU_DMAT_AVX2
+/* Per vertex: the weighted bone matrices are blended first, two columns per 256-bit register (eight FMAs for four influences),
+*  then the blended matrix transforms the position. Gathering the same data eight vertices wide measured slower,
+*  the gathers of 48 matrix elements per eight vertices dominating. */
+BU_TARGET_AVX2 void SkinLbsAvx2(const float *vert, const int *vertId, const float *vertWt, int beg, int end, const DMat *boneMat, const DMat &meshMat, float *oVert) {
+	assert(BU_MAX_INFLUENCING_BONE == 4);
+
+	const __m256 mesh01 = _mm256_loadu_ps(meshMat.d + 0);
+	const __m256 mesh23 = _mm256_loadu_ps(meshMat.d + 8);
+	const __m128 zeroEps = _mm_set_ss(0.001f * 0.001f);
+
+	for (int v = beg; v < end; v++) {
+		const float *p  = vert + 3 * v;
+		const int   *id = vertId + 4 * v;
+		const __m128 wt = _mm_loadu_ps(vertWt + 4 * v);
+
+		__m128 wsq = _mm_mul_ps(wt, wt);
+		wsq = _mm_add_ps(wsq, _mm_movehl_ps(wsq, wsq));
+		wsq = _mm_add_ss(wsq, _mm_shuffle_ps(wsq, wsq, 0x55));
+
+		__m256 c01, c23;
+		if (_mm_comilt_ss(wsq, zeroEps)) {
+			c01 = mesh01;
+			c23 = mesh23;
+		} else {
+			__m256 w0 = _mm256_set1_ps(_mm_cvtss_f32(wt));
+			__m256 w1 = _mm256_set1_ps(_mm_cvtss_f32(_mm_shuffle_ps(wt, wt, 0x55)));
+			__m256 w2 = _mm256_set1_ps(_mm_cvtss_f32(_mm_shuffle_ps(wt, wt, 0xAA)));
+			__m256 w3 = _mm256_set1_ps(_mm_cvtss_f32(_mm_shuffle_ps(wt, wt, 0xFF)));
+			const float *m0 = boneMat[id[0]].d, *m1 = boneMat[id[1]].d, *m2 = boneMat[id[2]].d, *m3 = boneMat[id[3]].d;
+			c01 = _mm256_mul_ps(w0, _mm256_loadu_ps(m0));
+			c23 = _mm256_mul_ps(w0, _mm256_loadu_ps(m0 + 8));
+			c01 = _mm256_fmadd_ps(w1, _mm256_loadu_ps(m1), c01);
+			c23 = _mm256_fmadd_ps(w1, _mm256_loadu_ps(m1 + 8), c23);
+			c01 = _mm256_fmadd_ps(w2, _mm256_loadu_ps(m2), c01);
+			c23 = _mm256_fmadd_ps(w2, _mm256_loadu_ps(m2 + 8), c23);
+			c01 = _mm256_fmadd_ps(w3, _mm256_loadu_ps(m3), c01);
+			c23 = _mm256_fmadd_ps(w3, _mm256_loadu_ps(m3 + 8), c23);
+		}
+
+		/* (x x x x y y y y) and (z z z z 1 1 1 1) against the column pairs, then the two halves summed */
+		__m256 xy = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(p[0])), _mm_set1_ps(p[1]), 1);
+		__m256 z1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(p[2])), _mm_set1_ps(1.0f), 1);
+		__m256 t = _mm256_fmadd_ps(c01, xy, _mm256_mul_ps(c23, z1));
+		__m128 r = _mm_add_ps(_mm256_castps256_ps128(t), _mm256_extractf128_ps(t, 1));
+
+		float out[4];
+		_mm_storeu_ps(out, r);
+		float *o = oVert + 3 * v;
+		o[0] = out[0]; o[1] = out[1]; o[2] = out[2];
+	}
+	_mm256_zeroupper();
+}
+#endif
+
+SkinLbsFn SkinLbsKernelSelect(const char **oName = NULL) {
+	const char *dummy;
+	const char **name = oName ? oName : &dummy;
+#ifdef BU_DMAT_AVX2
+	if (BuCpuHasAvx2Fma())
+		return (*name = "avx2", SkinLbsAvx2);
+#endif
+	return (*name = "scalar", SkinLbsScalar);
+}
+
+static const SkinLbsFn g_skinLbs = SkinLbsKernelSelect();
+
+/* Linear blend skinning of numVert vertices into oVert (3 * numVert floats), split over pool in ranges of 'grain' vertices.
+*  Bone ids must index boneMat - CheckSectionData and CheckSectionDataPacked hold them below the bone count. */
+void SkinLbs(const float *vert, const int *vertId, const float *vertWt, int numVert, const DMat *boneMat, const DMat &meshMat, float *oVert, ThreadPool *pool = NULL) {
+	const int grain = 4096;
+	int numRange = (numVert + grain - 1) / grain;
+
+	ParallelFor(pool, numRange, [&](int i) {
+		g_skinLbs(vert, vertId, vertWt, i * grain, min(numVert, (i + 1) * grain), boneMat, meshMat, oVert);
+	});
+}
+
+/* Dual quaternion skinning of one vertex, as vsBoneDQ computes it: influences are blended after flipping
+*  those in the opposite hemisphere from the first, and the blend is renormalized. Zero weights fall back to meshMat like SkinLbsOne. */
+inline void SkinDqsOne(const float *p, const int *id, const float *wt, const DDualQuat *boneDQ, const DMat &meshMat, float *o) {
+	float wsq = 0.0f;
+	for (int k = 0; k < BU_MAX_INFLUENCING_BONE; k++)
+		wsq += wt[k] * wt[k];
+
+	if (wsq < 0.001f * 0.001f) {
+		for (int r = 0; r < 3; r++)
+			o[r] = DMAT_ELT(meshMat, r, 0) * p[0] + DMAT_ELT(meshMat, r, 1) * p[1] + DMAT_ELT(meshMat, r, 2) * p[2] + DMAT_ELT(meshMat, r, 3);
+		return;
+	}
+
+	const float *r0 = boneDQ[id[0]].r;
+	float br[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	float bd[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int k = 0; k < BU_MAX_INFLUENCING_BONE; k++) {
+		const DDualQuat &q = boneDQ[id[k]];
+		float w = (q.r[0] * r0[0] + q.r[1] * r0[1] + q.r[2] * r0[2] + q.r[3] * r0[3]) < 0.0f ? -wt[k] : wt[k];
+		for (int j = 0; j < 4; j++) {
+			br[j] += w * q.r[j];
+			bd[j] += w * q.d[j];
+		}
+	}
+
+	float inv = 1.0f / sqrtf(br[0] * br[0] + br[1] * br[1] + br[2] * br[2] + br[3] * br[3]);
+	for (int j = 0; j < 4; j++) {
+		br[j] *= inv;
+		bd[j] *= inv;
+	}
+
+	DDualQuat::Transform(br, bd, p, o);
+}
+
+void SkinDqsRange(const float *vert, const int *vertId, const float *vertWt, int beg, int end, const DDualQuat *boneDQ, const DMat &meshMat, float *oVert) {
+	for (int v = beg; v < end; v++)
+		SkinDqsOne(vert + 3 * v, vertId + BU_MAX_INFLUENCING_BONE * v, vertWt + BU_MAX_INFLUENCING_BONE * v, boneDQ, meshMat, oVert + 3 * v);
+}
+
+/* Dual quaternion counterpart of SkinLbs; boneDQ from DDualQuat::MakeFromMatMany over the same bone matrices */
+void SkinDqs(const float *vert, const int *vertId, const float *vertWt, int numVert, const DDualQuat *boneDQ, const DMat &meshMat, float *oVert, ThreadPool *pool = NULL) {
+	const int grain = 4096;
+	int numRange = (numVert + grain - 1) / grain;
+
+	ParallelFor(pool, numRange, [&](int i) {
+		SkinDqsRange(vert, vertId, vertWt, i * grain, min(numVert, (i + 1) * grain), boneDQ, meshMat, oVert);
+	});
+}
+
+void SkinLbsMesh(const SectionData &sd, int mesh, const DMat *boneMat, const DMat &meshMat, vector<float> *oVert, ThreadPool *pool = NULL) {
+	int numVert = sd.meshVert[mesh].size() / 3;
+	oVert->resize(3 * numVert);
+	if (numVert)
+		SkinLbs(&sd.meshVert[mesh][0], &sd.meshVertId[mesh][0], &sd.meshVertWt[mesh][0], numVert, boneMat, meshMat, &(*oVert)[0], pool);
+}
+
+void SkinLbsMesh(const SectionDataPacked &sd, int mesh, const DMat *boneMat, const DMat &meshMat, vector<float> *oVert, ThreadPool *pool = NULL) {
+	int numVert = sd.meshVert.Count(mesh) / 3;
+	oVert->resize(3 * numVert);
+	if (numVert)
+		SkinLbs(sd.meshVert.Ptr(mesh), sd.meshVertId.Ptr(mesh), sd.meshVertWt.Ptr(mesh), numVert, boneMat, meshMat, &(*oVert)[0], pool);
+}
+
+void SkinLbsMesh(const SectionDataBaked &sd, int mesh, const DMat *boneMat, const DMat &meshMat, vector<float> *oVert, ThreadPool *pool = NULL) {
+	int numVert = sd.NumVert(mesh);
+	oVert->resize(3 * numVert);
+	if (numVert)
+		SkinLbs(sd.Vert(mesh), sd.VertId(mesh), sd.VertWt(mesh), numVert, boneMat, meshMat, &(*oVert)[0], pool);
+}
+
+/* Linear blend skinning from quantised streams: blocks of vertices are decoded to float scratch and handed to the selected SkinLbs kernel */
+void SkinLbsQ(const MeshVertQ &q, const DMat *boneMat, const DMat &meshMat, float *oVert, ThreadPool *pool = NULL) {
+	const int grain = 4096;
+	const int block = 256;
+	int numRange = (q.numVert + grain - 1) / grain;
+
+	ParallelFor(pool, numRange, [&](int i) {
+		float vert[3 * block + 1];
+		int   id[BU_MAX_INFLUENCING_BONE * block];
+		float wt[BU_MAX_INFLUENCING_BONE * block];
+
+		for (int b = i * grain; b < min(q.numVert, (i + 1) * grain); b += block) {
+			int n = min(block, min(q.numVert, (i + 1) * grain) - b);
+			q.Decode(b, n, vert, id, wt);
+			g_skinLbs(vert, id, wt, 0, n, boneMat, meshMat, oVert + 3 * b);
+		}
+	});
+}
+
+void MakeMeshVertQ(const SectionData &sd, MeshVertQ::PosFormat posFormat, MeshVertQ::WtFormat wtFormat, vector<MeshVertQ> *oQ) {
+	oQ->resize(sd.meshName.size());
+	for (int m = 0; m < oQ->size(); m++) {
+		int numVert = sd.meshVert[m].size() / 3;
+		MeshVertQ::Make(sd.meshVert[m].data(), sd.meshVertId[m].data(), sd.meshVertWt[m].data(), numVert, posFormat, wtFormat, &(*oQ)[m]);
+	}
+}
+
+void MakeMeshVertQ(const SectionDataPacked &sd, MeshVertQ::PosFormat posFormat, MeshVertQ::WtFormat wtFormat, vector<MeshVertQ> *oQ) {
+	oQ->resize(sd.meshName.size());
+	for (int m = 0; m < oQ->size(); m++)
+		MeshVertQ::Make(sd.meshVert.Ptr(m), sd.meshVertId.Ptr(m), sd.meshVertWt.Ptr(m), sd.meshVert.Count(m) / 3, posFormat, wtFormat, &(*oQ)[m]);
+}
+
+/* Scratch ints MeshWeldRemap needs for 'numVert' vertices: an open addressing table, at most half full */
+inline int MeshWeldTableSize(int numVert) {
+	int tableSize = 1;
+	while (tableSize < 2 * numVert)
+		tableSize *= 2;
+	return tableSize;
+}
+
+/* Numbers the vertices as MeshWeld would leave them without moving anything: vertices bit for bit equal in position,
+*  bone ids and weights share a number, survivors are numbered in order of first occurrence (so vertex v is a survivor
+*  exactly when oRemap[v] equals the count of survivors before it). 'table' is MeshWeldTableSize(numVert) ints of
+*  scratch. Returns the welded vertex count. */
+int MeshWeldRemap(const float *vert, const int *vertId, const float *vertWt, int numVert, int *table, int *oRemap) {
+	const int K = BU_MAX_INFLUENCING_BONE;
+
+	int tableSize = MeshWeldTableSize(numVert);
+	fill(table, table + tableSize, -1);
+	int numOut = 0;
+
+	for (int v = 0; v < numVert; v++) {
+		/* FNV-1a over the 32 bit words of the vertex */
+		uint32_t h = 2166136261u;
+		uint32_t w[3 + 2 * K];
+		memcpy(w, vert + 3 * v, 3 * 4);
+		memcpy(w + 3, vertId + K * v, K * 4);
+		memcpy(w + 3 + K, vertWt + K * v, K * 4);
+		for (int i = 0; i < 3 + 2 * K; i++)
+			h = (h ^ w[i]) * 16777619u;
+
+		/* Slots hold the first occurrence of each distinct vertex */
+		int slot = h & (tableSize - 1);
+		for (;; slot = (slot + 1) & (tableSize - 1)) {
+			int u = table[slot];
+			if (u == -1) {
+				table[slot] = v;
+				oRemap[v] = numOut++;
+				break;
+			}
+			if (memcmp(vert + 3 * u, vert + 3 * v, 3 * sizeof(float)) == 0 &&
+				memcmp(vertId + K * u, vertId + K * v, K * sizeof(int)) == 0 &&
+				memcmp(vertWt + K * u, vertWt + K * v, K * sizeof(float)) == 0)
+			{
+				oRemap[v] = oRemap[u];
+				break;
+			}
+		}
+	}
+
+	return numOut;
+}
+
+/* Merges vertices that are bit for bit equal in position, bone ids and weights, rewriting 'index'.
+*  Survivors are compacted in place in order of first occurrence; returns the new vertex count. */
+int MeshWeld(float *vert, int *index, int *vertId, float *vertWt, int numVert, int numIndex) {
+	const int K = BU_MAX_INFLUENCING_BONE;
+
+	vector<int> table(MeshWeldTableSize(numVert));
+	vector<int> remap(numVert);
+	int numOut = MeshWeldRemap(vert, vertId, vertWt, numVert, table.data(), remap.data());
+
+	/* Survivor k sits at or after slot k, so the copy never clobbers a vertex still to be read */
+	for (int v = 0, k = 0; v < numVert; v++) {
+		if (remap[v] != k)
+			continue;
+		memmove(vert + 3 * k, vert + 3 * v, 3 * sizeof(float));
+		memmove(vertId + K * k, vertId + K * v, K * sizeof(int));
+		memmove(vertWt + K * k, vertWt + K * v, K * sizeof(float));
+		k++;
+	}
+
+	for (int i = 0; i < numIndex; i++) {
+		assert(index[i] >= 0 && index[i] < numVert);
+		index[i] = remap[index[i]];
+	}
+
+	return numOut;
+}
+
+class MeshWeldResult {
+public:
+	int numVertBefore;
+	int numVertAfter;
+};
+
+/* Welds every mesh of 'sd' (See MeshWeld), shrinking meshVert, meshVertId and meshVertWt; one task per mesh */
+void MeshWeld(SectionData *sd, vector<MeshWeldResult> *oRes = NULL, ThreadPool *pool = NULL) {
+	const int K = BU_MAX_INFLUENCING_BONE;
+	int numMesh = sd->meshName.size();
+	vector<MeshWeldResult> res(numMesh);
+
+	ParallelFor(pool, numMesh, [&](int m) {
+		int numVert = sd->meshVert[m].size() / 3;
+		res[m].numVertBefore = numVert;
+		res[m].numVertAfter  = numVert ? MeshWeld(sd->meshVert[m].data(), sd->meshIndex[m].data(), sd->meshVertId[m].data(), sd->meshVertWt[m].data(),
+			numVert, sd->meshIndex[m].size()) : 0;
+		sd->meshVert[m].resize(3 * res[m].numVertAfter);
+		sd->meshVertId[m].resize(K * res[m].numVertAfter);
+		sd->meshVertWt[m].resize(K * res[m].numVertAfter);
+	});
+
+	if (oRes)
+		oRes->swap(res);
+}
+
+/* 16 bit copy of 'index' for meshes of fewer than 65536 vertices (0xFFFF stays free as a primitive restart index).
+*  Returns false, leaving oIndex alone, for larger meshes. */
+bool MeshIndex16(const int *index, int numIndex, int numVert, vector<uint16_t> *oIndex) {
+	if (numVert >= 65536)
+		return false;
+
+	oIndex->resize(numIndex);
+	for (int i = 0; i < numIndex; i++) {
+		assert(index[i] >= 0 && index[i] < numVert);
+		(*oIndex)[i] = (uint16_t)index[i];
+	}
+
+	return true;
+}
+
+/* Average cache miss ratio (transformed vertices per triangle) of an index buffer through a FIFO post-transform cache.
+*  1.0 or below is good, 3.0 is no reuse at all. */
+float MeshAcmr(const int *index, int numIndex, int numVert, int cacheSize = 16) {
+	/* A vertex is cached while fewer than cacheSize misses happened since its own */
+	vector<int> missAt(numVert, INT_MIN / 2);
+	int miss = 0;
+
+	for (int i = 0; i < numIndex; i++) {
+		int v = index[i];
+		assert(v >= 0 && v < numVert);
+		if (miss - missAt[v] >= cacheSize) {
+			missAt[v] = miss;
+			miss++;
+		}
+	}
+
+	return numIndex ? (float)miss / (numIndex / 3) : 0.0f;
+}
+
+/* Forsyth, "Linear-Speed Vertex Cache Optimisation": cache position (LRU of 32, the last triangle's three scoring flat)
+*  plus a boost for vertices with few triangles left, so that nearly finished vertices get finished. */
+inline float MeshVertexCacheScore(int cachePos, int numLive) {
+	const int cacheSize = 32;
+
+	if (numLive == 0)
+		return -1.0f;
+
+	float s = 0.0f;
+	if (cachePos >= 0)
+		s = cachePos < 3 ? 0.75f : powf(1.0f - (cachePos - 3) * (1.0f / (cacheSize - 3)), 1.5f);
+
+	return s + 2.0f / sqrtf((float)numLive);
+}
+
+/* Reorders the triangles of 'index' into oIndex (not aliasing) for post-transform cache reuse (See MeshVertexCacheScore).
+*  Only the triangles of vertices in the simulated cache are rescored after each step; when none is left the next
+*  unemitted triangle in input order is taken. */
+void MeshOptimizeVertexCache(const int *index, int numIndex, int numVert, int *oIndex) {
+	const int cacheSize = 32;
+	int numTri = numIndex / 3;
+
+	assert(numIndex % 3 == 0 && index != oIndex);
+
+	/* Triangles of each vertex [triBeg[v], triBeg[v+1]), of which the first live[v] are not emitted yet */
+	vector<int> live(numVert, 0), triBeg(numVert + 1, 0), triOf(numIndex);
+	for (int i = 0; i < numIndex; i++) {
+		assert(index[i] >= 0 && index[i] < numVert);
+		live[index[i]]++;
+	}
+	for (int v = 0; v < numVert; v++)
+		triBeg[v + 1] = triBeg[v] + live[v];
+	{
+		vector<int> fill(triBeg.begin(), triBeg.end() - 1);
+		for (int i = 0; i < numIndex; i++)
+			triOf[fill[index[i]]++] = i / 3;
+	}
+
+	vector<int>   cachePos(numVert, -1);
+	vector<float> score(numVert);
+	for (int v = 0; v < numVert; v++)
+		score[v] = MeshVertexCacheScore(-1, live[v]);
+
+	vector<char> emitted(numTri, 0);
+	int cache[cacheSize + 3], cacheN = 0;
+	int cursor = 0;
+
+	int   best = -1;
+	float bestScore = -FLT_MAX;
+	for (int t = 0; t < numTri; t++) {
+		float ts = score[index[3 * t]] + score[index[3 * t + 1]] + score[index[3 * t + 2]];
+		if (ts > bestScore)
+			best = t, bestScore = ts;
+	}
+
+	for (int o = 0; o < numTri; o++) {
+		if (best < 0) {
+			while (emitted[cursor])
+				cursor++;
+			best = cursor;
+		}
+
+		const int *tri = index + 3 * best;
+		emitted[best] = 1;
+		oIndex[3 * o + 0] = tri[0];
+		oIndex[3 * o + 1] = tri[1];
+		oIndex[3 * o + 2] = tri[2];
+
+		/* Swap the triangle out of the live part of its vertices' lists (listed once per corner, degenerate ones included) */
+		for (int k = 0; k < 3; k++) {
+			int v = tri[k];
+			int *b = &triOf[triBeg[v]];
+			int j = 0;
+			while (b[j] != best)
+				j++;
+			swap(b[j], b[live[v] - 1]);
+			live[v]--;
+		}
+
+		/* LRU: the triangle's vertices move to the front, at most 3 fall off the back */
+		int nc[cacheSize + 3], n = 0;
+		for (int k = 0; k < 3; k++)
+			if (find(nc, nc + n, tri[k]) == nc + n)
+				nc[n++] = tri[k];
+		for (int i = 0; i < cacheN; i++)
+			if (cache[i] != tri[0] && cache[i] != tri[1] && cache[i] != tri[2])
+				nc[n++] = cache[i];
+
+		for (int i = 0; i < n; i++) {
+			cachePos[nc[i]] = i < cacheSize ? i : -1;
+			score[nc[i]] = MeshVertexCacheScore(cachePos[nc[i]], live[nc[i]]);
+		}
+
+		best = -1;
+		bestScore = -FLT_MAX;
+		for (int i = 0; i < min(n, cacheSize); i++) {
+			int v = nc[i];
+			for (int j = 0; j < live[v]; j++) {
+				int t = triOf[triBeg[v] + j];
+				float ts = score[index[3 * t]] + score[index[3 * t + 1]] + score[index[3 * t + 2]];
+				if (ts > bestScore)
+					best = t, bestScore = ts;
+			}
+		}
+
+		cacheN = min(n, cacheSize);
+		copy(nc, nc + cacheN, cache);
+	}
+}
+
+/* Renumbers vertices in order of first use by 'index' (rewritten in place) so that vertex fetch walks memory forward.
+*  oRemap[old] = new; vertices no triangle uses keep their relative order after all used ones. */
+void MeshOptimizeVertexFetch(int *index, int numIndex, int numVert, int *oRemap) {
+	int next = 0;
+
+	fill(oRemap, oRemap + numVert, -1);
+	for (int i = 0; i < numIndex; i++) {
+		assert(index[i] >= 0 && index[i] < numVert);
+		if (oRemap[index[i]] < 0)
+			oRemap[index[i]] = next++;
+		index[i] = oRemap[index[i]];
+	}
+	for (int v = 0; v < numVert; v++)
+		if (oRemap[v] < 0)
+			oRemap[v] = next++;
+}
+
+class MeshOptimizeResult {
+public:
+	int   numTri;
+	float acmrBefore;
+	float acmrAfter;
+};
+
+/* Cache order for the triangles, then fetch order for the vertices; positions, ids and weights move together */
+MeshOptimizeResult MeshOptimize(float *vert, int *index, int *vertId, float *vertWt, int numVert, int numIndex) {
+	const int K = BU_MAX_INFLUENCING_BONE;
+	MeshOptimizeResult res;
+
+	res.numTri     = numIndex / 3;
+	res.acmrBefore = MeshAcmr(index, numIndex, numVert);
+
+	vector<int> tmpIndex(index, index + numIndex);
+	if (numIndex)
+		MeshOptimizeVertexCache(&tmpIndex[0], numIndex, numVert, index);
+
+	vector<int> remap(numVert);
+	if (numVert)
+		MeshOptimizeVertexFetch(index, numIndex, numVert, &remap[0]);
+
+	vector<float> tmpVert(vert, vert + 3 * numVert), tmpWt(vertWt, vertWt + K * numVert);
+	vector<int>   tmpId(vertId, vertId + K * numVert);
+	for (int v = 0; v < numVert; v++) {
+		int r = remap[v];
+		copy(&tmpVert[3 * v], &tmpVert[3 * v] + 3, vert + 3 * r);
+		copy(&tmpId[K * v], &tmpId[K * v] + K, vertId + K * r);
+		copy(&tmpWt[K * v], &tmpWt[K * v] + K, vertWt + K * r);
+	}
+
+	res.acmrAfter = MeshAcmr(index, numIndex, numVert);
+
+	return res;
+}
+
+/* Optional pass after loading (or before BakeSectionData), one task per mesh */
+void MeshOptimize(SectionData *sd, vector<MeshOptimizeResult> *oRes = NULL, ThreadPool *pool = NULL) {
+	int numMesh = sd->meshName.size();
+	vector<MeshOptimizeResult> res(numMesh);
+
+	ParallelFor(pool, numMesh, [&](int m) {
+		res[m] = MeshOptimize(sd->meshVert[m].data(), sd->meshIndex[m].data(), sd->meshVertId[m].data(), sd->meshVertWt[m].data(),
+			sd->meshVert[m].size() / 3, sd->meshIndex[m].size());
+	});
+
+	if (oRes)
+		oRes->swap(res);
+}
+
+void MeshOptimize(SectionDataPacked *sd, vector<MeshOptimizeResult> *oRes = NULL, ThreadPool *pool = NULL) {
+	int numMesh = sd->meshName.size();
+	vector<MeshOptimizeResult> res(numMesh);
+
+	ParallelFor(pool, numMesh, [&](int m) {
+		res[m] = MeshOptimize(sd->meshVert.Ptr(m), sd->meshIndex.Ptr(m), sd->meshVertId.Ptr(m), sd->meshVertWt.Ptr(m),
+			sd->meshVert.Count(m) / 3, sd->meshIndex.Count(m));
+	});
+
+	if (oRes)
+		oRes->swap(res);
+}
+
+class Parse {
+public:
+	/* 1 for files without the v2 header (See BU_DAT_MAGIC). Read as the lenTotal of a v1 first section the magic is
+	*  1413764418 (0x54445542), so detection assumes no v1 file opens with a section of about 1.4GB. */
+	static int ReadDatVersion(const P &inP) {
+		P w(inP);
+
+		if (w.BytesLeft() < BU_DAT_HEADER || w.ReadString(sizeof BU_DAT_MAGIC) != string(BU_DAT_MAGIC, sizeof BU_DAT_MAGIC))
+			return 1;
+
+		int version   = w.ReadIntUnchecked();
+		int lenHeader = w.ReadIntUnchecked();
+
+		if (version != BU_DAT_VERSION)
+			throw ExcVersion();
+		assert(lenHeader == BU_DAT_HEADER);
+
+		return version;
+	}
+
+	/* Positioned at the first section */
+	static P SkipDatHeader(const P &inP, int version) {
+		P w(inP);
+
+		if (version != 1)
+			w.AdvanceN(BU_DAT_HEADER);
+
+		return w;
+	}
+
+	static vector<Section> ReadSection(const P &inP) {
+		vector<Section> sec;
+		int version = ReadDatVersion(inP);
+		P w(SkipDatHeader(inP, version));
+
+		int bleft = w.BytesLeft() + 1;
+
+		while (w.BytesLeft() < bleft && (bleft = w.BytesLeft()) != 0) {
+			sec.push_back(Section(w.ReadSectionWeak(version)));
+		}
+
+		return sec;
+	}
+
+	static bool SectionExistByName(const vector<Section> &sec, const string &name) {
+		for (auto &i : sec)
+			if (i.name == name)
 				return true;
 		return false;
 	}
@@ -539,122 +3500,651 @@ public:
 		throw ExcItemExist();
 	}
 
-	static SectionDataEx * MakeSectionDataEx(const P &inP) {
-		vector<Section> sec = ReadSection(inP);
+	/* Skips (does not index) sections not listed in 'wanted'; an empty 'wanted' indexes everything. */
+	static void ReadSectionIndex(const P &inP, const vector<string> &wanted, SectionIndex *oIdx) {
+		int version = ReadDatVersion(inP);
+		P w(SkipDatHeader(inP, version));
+
+		int bleft = w.BytesLeft() + 1;
+
+		while (w.BytesLeft() < bleft && (bleft = w.BytesLeft()) != 0) {
+			Section s(w.ReadSectionWeak(version));
+			if (wanted.empty() || find(wanted.begin(), wanted.end(), s.name) != wanted.end())
+				oIdx->Add(s);
+		}
+	}
+
+	/* SECTIONTOC is written last by BlendGen.py: [LenDel name, int offset]* followed by an int holding the lenTotal of SECTIONTOC itself.
+	*  The trailing int allows finding the TOC from the end of the file, then going straight to each listed section.
+	*  Returns false (and leaves oIdx alone) when the file has no TOC.
+	*  In v2 the offsets are from the start of the file (header included) and each listed section has its checksum verified. */
+	static bool ReadSectionToc(const P &inP, SectionIndex *oIdx) {
+		const string tocName("SECTIONTOC");
+		int version = ReadDatVersion(inP);
+		int beg = version == 1 ? 0 : BU_DAT_HEADER;
+		int n = inP.BytesLeft();
+
+		int lenHeader = version == 1 ? BU_DAT_SECTION_HEADER_V1 : BU_DAT_SECTION_HEADER_V2;
+		int lenName   = version == 1 ? tocName.size() : DatAlign(tocName.size());
+
+		if (n - beg < 4)
+			return false;
+
+		int lenTotal = inP.SubRel(n - 4, 4).ReadIntUnchecked();
+
+		if (lenTotal < lenHeader + lenName + 4 || lenTotal > n - beg)
+			return false;
+
+		P t(inP.SubRel(n - lenTotal, lenTotal));
+		int hTotal = t.ReadIntUnchecked(), hName = t.ReadIntUnchecked(), hData = t.ReadIntUnchecked();
+
+		if (hTotal != lenTotal || hName != tocName.size() || hData != lenTotal - lenHeader - lenName)
+			return false;
+		if (version != 1)
+			t.AdvanceInt();
+		if (t.ReadString(hName) != tocName)
+			return false;
+
+		Section toc(P(inP.SubRel(n - lenTotal, lenTotal)).ReadSectionWeak(version));
+		P e(P(toc.data).SubRel(0, hData - 4));
+		SectionIndex idx;
+
+		while (e.BytesLeft()) {
+			string name = e.ReadLenDel();
+			int    off  = e.ReadInt();
+			assert(off >= beg && off < n - lenTotal);
+			assert(version == 1 || off % BU_DAT_ALIGN == 0);
+			P w(inP.SubRel(off, n - lenTotal - off));
+			Section s(w.ReadSectionWeak(version));
+			assert(s.name == name);
+			idx.Add(s);
+		}
+
+		*oIdx = idx;
+
+		return true;
+	}
+
+	/* With a 'pool', meshes are decoded in parallel (See FillSectionData) */
+	static SectionDataEx * MakeSectionDataEx(const P &inP, ThreadPool *pool = NULL) {
+		SectionIndex idx;
+
+		if (!ReadSectionToc(inP, &idx))
+			ReadSectionIndex(inP, vector<string>(), &idx);
 
-		SectionDataEx *sd = new SectionDataEx();
-		FillSectionData(sec, sd);
+		/* Owned until checked - the fill throws on a missing section or a broken hierarchy */
+		unique_ptr<SectionDataEx> sd(new SectionDataEx());
+		FillSectionData(idx, sd.get(), pool);
 		CheckSectionData(*sd);
 
-		return sd;
+		return sd.release();
 	}
 
 	static void FillSectionData(const vector<Section> &sec, SectionData *outSD) {
-		FillLenDel(SectionGetByName(sec, "MESHNAME").data, &outSD->meshName);
-		FillInt(SectionGetByName(sec, "MESHPARENT").data, &outSD->meshParent);
-		FillMat(SectionGetByName(sec, "MESHMATRIX").data, &outSD->meshMatrix);
+		SectionIndex idx;
+		for (auto &i : sec)
+			idx.Add(i);
+		FillSectionData(idx, outSD);
+	}
+
+	static void FillSectionData(const SectionIndex &idx, SectionData *outSD, ThreadPool *pool = NULL) {
+		FillSectionDataHier(idx, outSD);
+
+		int numMesh = outSD->meshName.size();
+
+		vector<Slice> mVertChunks, mIndexChunks, mBWChunks;
+		vector<int>   mBWBase;
+		mMeshChunks(idx, numMesh, &mVertChunks, &mIndexChunks, &mBWChunks, &mBWBase);
+
+		outSD->meshVert.resize(numMesh);
+		outSD->meshIndex.resize(numMesh);
+		outSD->meshVertId.resize(numMesh);
+		outSD->meshVertWt.resize(numMesh);
+
+		/* Meshes are independent - each task writes only its own mesh's entries */
+		ParallelFor(pool, numMesh, [&](int m) {
+			int numVert = mNumVertFromSize(mVertChunks[m].size() / 4);
+
+			FillFloat(mVertChunks[m], &outSD->meshVert[m]);
+			FillInt(mIndexChunks[m], &outSD->meshIndex[m]);
+			assert(outSD->meshIndex[m].size() % 3 == 0);
+
+			outSD->meshVertId[m].resize(BU_MAX_INFLUENCING_BONE * numVert);
+			outSD->meshVertWt[m].resize(BU_MAX_INFLUENCING_BONE * numVert);
+			if (numVert)
+				mFillVertWeightBatch(&mBWChunks[mBWBase[m]], numVert, &outSD->meshVertId[m][0], &outSD->meshVertWt[m][0]);
+		});
+	}
+
+	/* Per-mesh chunks of MESHVERT, MESHINDEX and the flat MESHVERTBONEWEIGHT chunk list (See FillMeshVertBoneWeight).
+	*  oBWBase[m] is the index of Mesh m's first vertex in oBWChunks, as a prefix sum of vertex counts taken from the MESHVERT chunk sizes. */
+	template<typename VS>
+	static void mMeshChunks(const SectionIndex &idx, int numMesh, VS *oVertChunks, VS *oIndexChunks, VS *oBWChunks, vector<int> *oBWBase) {
+		FillLenDelSlice(idx.Get("MESHVERT").data, oVertChunks);
+		FillLenDelSlice(idx.Get("MESHINDEX").data, oIndexChunks);
+		FillLenDelSlice(idx.Get("MESHVERTBONEWEIGHT").data, oBWChunks);
+
+		assert(oVertChunks->size() == numMesh && oIndexChunks->size() == numMesh);
+
+		oBWBase->resize(numMesh);
+		int currBaseIdx = 0;
+		for (int m = 0; m < numMesh; m++) {
+			assert((*oVertChunks)[m].size() % 4 == 0 && (*oIndexChunks)[m].size() % 4 == 0);
+			(*oBWBase)[m] = currBaseIdx;
+			currBaseIdx += mNumVertFromSize((*oVertChunks)[m].size() / 4);
+		}
+		assert(oBWChunks->size() == currBaseIdx);
+	}
+
+	static SectionDataEx * MakeSectionDataExStream(SectionPipeline *pipe) {
+		unique_ptr<SectionDataEx> sd(new SectionDataEx());
+		FillSectionDataStream(pipe, sd.get());
+		CheckSectionData(*sd);
+
+		return sd.release();
+	}
+
+	/* Decodes sections in arrival order, while the pipeline keeps reading the ones behind.
+	*  MESHVERTBONEWEIGHT needs MESHNAME and MESHVERT decoded first and is held back until they are. */
+	static void FillSectionDataStream(SectionPipeline *pipe, SectionData *outSD) {
+		const char *required[] = {
+			"MESHNAME", "MESHPARENT", "MESHMATRIX",
+			"BONENAME", "BONEPARENT", "BONEMATRIX",
+			"MESHVERT", "MESHINDEX", "MESHVERTBONEWEIGHT",
+		};
+
+		map<string, bool> seen;
+		vector<Section>   heldBack;
+		SectionIndex      animIdx;
+
+		Section sec("", Slice(slice_str_t(), string()));
+
+		while (pipe->Pop(&sec)) {
+			if (sec.name == "MESHVERTBONEWEIGHT" && !(seen["MESHNAME"] && seen["MESHVERT"])) {
+				heldBack.push_back(sec);
+			} else if (sec.name.compare(0, 4, "ANIM") == 0) {
+				/* The ANIM* sections only decode together */
+				animIdx.Add(sec);
+			} else {
+				FillSectionOne(sec, outSD);
+			}
+			seen[sec.name] = true;
+		}
+
+		for (auto &i : heldBack)
+			FillSectionOne(i, outSD);
+
+		for (int i = 0; i < sizeof required / sizeof *required; i++)
+			if (!seen[required[i]])
+				throw ExcItemExist();
+
+		if (!seen["BONEINVBIND"])
+			FillBoneInvBind(outSD->boneMatrix, &outSD->boneInvBind);
+
+		assert(outSD->boneName.size() <= BU_MAX_TOTAL_BONE_PER_MESH);
+
+		FillChild(outSD->meshParent, &outSD->meshChild);
+		FillChild(outSD->boneParent, &outSD->boneChild);
+
+		FillTopo("mesh", outSD->meshParent, outSD->meshChild, &outSD->meshTopo);
+		FillTopo("bone", outSD->boneParent, outSD->boneChild, &outSD->boneTopo);
+
+		FillBoneRestLocal(outSD);
+		FillAnim(animIdx, &outSD->anim);
+	}
+
+	static void FillSectionOne(const Section &sec, SectionData *outSD) {
+		if (sec.name == "MESHNAME")
+			FillLenDel(sec.data, &outSD->meshName);
+		else if (sec.name == "MESHPARENT")
+			FillInt(sec.data, &outSD->meshParent);
+		else if (sec.name == "MESHMATRIX")
+			FillMat(sec.data, &outSD->meshMatrix);
+		else if (sec.name == "BONENAME")
+			FillLenDel(sec.data, &outSD->boneName);
+		else if (sec.name == "BONEPARENT")
+			FillInt(sec.data, &outSD->boneParent);
+		else if (sec.name == "BONEMATRIX")
+			FillMat(sec.data, &outSD->boneMatrix);
+		else if (sec.name == "BONEINVBIND")
+			FillMat(sec.data, &outSD->boneInvBind);
+		else if (sec.name == "MESHVERT")
+			FillMeshVert(sec.data, &outSD->meshVert);
+		else if (sec.name == "MESHINDEX")
+			FillMeshIndex(sec.data, &outSD->meshIndex);
+		else if (sec.name == "MESHVERTBONEWEIGHT")
+			FillMeshVertBoneWeight(sec.data, outSD->meshName.size(), outSD->meshVert, &outSD->meshVertId, &outSD->meshVertWt);
+		/* Unknown sections are ignored, same as with FillSectionData */
+	}
+
+	static void FillMeshVert(const Slice &sec, vector<vector<float> > *outMeshVert) {
+		vector<Slice>          mVertChunks;
+		vector<vector<float> > mVert;
+		FillLenDelSlice(sec, &mVertChunks);
+		mVert.resize(mVertChunks.size());
+		for (int i = 0; i < mVertChunks.size(); i++) {
+			FillFloat(mVertChunks[i], &mVert[i]);
+			assert(mVert[i].size() % 3 == 0);
+		}
+		outMeshVert->swap(mVert);
+	}
+
+	static void FillMeshIndex(const Slice &sec, vector<vector<int> > *outMeshIndex) {
+		vector<Slice>        mIndexChunks;
+		vector<vector<int> > mIndex;
+		FillLenDelSlice(sec, &mIndexChunks);
+		mIndex.resize(mIndexChunks.size());
+		for (int i = 0; i < mIndexChunks.size(); i++) {
+			FillInt(mIndexChunks[i], &mIndex[i]);
+			assert(mIndex[i].size() % 3 == 0);
+		}
+		outMeshIndex->swap(mIndex);
+	}
+
+	static void FillMeshVertBoneWeight(const Slice &sec, int numMesh, const vector<vector<float> > &meshVert, vector<vector<int> > *outMeshVertId, vector<vector<float> > *outMeshVertWt) {
+		vector<vector<int> > mVBWeightId;
+		vector<vector<float> > mVBWeightWt;
+
+		assert(numMesh == meshVert.size());
+
+		vector<Slice> mBWChunks;
+		FillLenDelSlice(sec, &mBWChunks);
+		/* MESHVERTBONEWEIGHT stored as flat (MeshN x VertOfMeshN) -> [pairIdWt, ...]
+		*  Accumulate-skip numVert[MeshN] entries to get to Mesh_{N+1} data. */
+		assert(mBWChunks.size() == accumulate(meshVert.begin(), meshVert.end(), 0, [](int a, const vector<float> &x) { return a + mNumVertFromSize(x.size()); }));
+
+		mVBWeightId = vector<vector<int> >(numMesh);
+		mVBWeightWt = vector<vector<float> >(numMesh);
+		for (int i = 0; i < numMesh; i++) {
+			int numVert = mNumVertFromSize(meshVert[i].size());
+			mVBWeightId[i] = vector<int>(BU_MAX_INFLUENCING_BONE * numVert);
+			mVBWeightWt[i] = vector<float>(BU_MAX_INFLUENCING_BONE * numVert);
+		}
+
+		int currBaseIdx = 0;
+		for (int m = 0; m < numMesh; m++) {
+			int numVert = mNumVertFromSize(meshVert[m].size());
+			if (numVert)
+				mFillVertWeightBatch(&mBWChunks[currBaseIdx], numVert, &mVBWeightId[m][0], &mVBWeightWt[m][0]);
+			currBaseIdx += numVert;
+		}
+
+		*outMeshVertId = mVBWeightId;
+		*outMeshVertWt = mVBWeightWt;
+	}
+
+	/* Writes BU_MAX_INFLUENCING_BONE ids and normalized weights for each of 'numVert' vertices described by 'chunk'.
+	*  Output is BU_MAX_INFLUENCING_BONE entries per vertex, vertices back to back. */
+	static void mFillVertWeightBatch(const Slice *chunk, int numVert, int *oId, float *oWt) {
+		for (int i = 0; i < numVert; i++)
+			mFillVertWeight(chunk[i], oId + BU_MAX_INFLUENCING_BONE * i, oWt + BU_MAX_INFLUENCING_BONE * i);
+	}
+
+	/* Top-K selection of the influences by descending weight, then normalization (See mFillVertWeightSort for the rationale).
+	*  Works on fixed size stack arrays, no allocation. Same output as mFillVertWeightSort, ties keep file order. */
+	static void mFillVertWeight(const Slice &chunk, int *oId, float *oWt) {
+		const int K = BU_MAX_INFLUENCING_BONE;
+		const int B = 16;
+
+		P w(chunk);
+
+		assert(w.BytesLeft() % (4+4) == 0);
+
+		int   id[K];
+		float wt[K];
+		int   k = 0;
+
+		while (w.BytesLeft()) {
+			int n = min(B, w.BytesLeft() / (4+4));
+			union { int32_t i; float f; } pr[2 * B];
+			w.ReadBulk32(pr, 2 * n);
+
+			for (int j = 0; j < n; j++) {
+				int   ci = pr[2 * j].i;
+				float cw = pr[2 * j + 1].f;
+				int   pos;
+
+				assert(P::CheckIntArbitraryLimit(ci));
+
+				if (k < K)
+					pos = k++;
+				else if (cw > wt[K - 1])
+					pos = K - 1;
+				else
+					continue;
+
+				for (; pos > 0 && wt[pos - 1] < cw; pos--) {
+					wt[pos] = wt[pos - 1];
+					id[pos] = id[pos - 1];
+				}
+				wt[pos] = cw;
+				id[pos] = ci;
+			}
+		}
+
+		/* Zero pad if too few */
+		for (; k < K; k++) {
+			id[k] = 0;
+			wt[k] = 0.0f;
+		}
+
+		/* Summed in the same (descending) order as mFillVertWeightSort, for identical rounding */
+		float influWeightSum = 0.0f;
+		for (int j = 0; j < K; j++)
+			influWeightSum += wt[j];
+
+		bool doNorm = !ScaZero(influWeightSum);
+		for (int j = 0; j < K; j++) {
+			oId[j] = id[j];
+			oWt[j] = doNorm ? wt[j] / influWeightSum : wt[j];
+		}
+	}
 
-		FillLenDel(SectionGetByName(sec, "BONENAME").data, &outSD->boneName);
-		FillInt(SectionGetByName(sec, "BONEPARENT").data, &outSD->boneParent);
-		FillMat(SectionGetByName(sec, "BONEMATRIX").data, &outSD->boneMatrix);
+	/* Reference implementation of mFillVertWeight, kept for BlendUtilBenchVertWeight */
+	static void mFillVertWeightSort(const Slice &chunk, int *oId, float *oWt) {
+		vector<pair<int, float> > v;
+		FillPairIntFloat(chunk, &v);
+
+		vector<pair<int, float> > finals = v;
+
+		/* Sort by Descending weight, ties keep file order */
+		stable_sort(finals.begin(), finals.end(),
+			[](const pair<int, float> &a, const pair<int, float> &b) {
+				/* FIXME: Floating point comparison sync alert */
+				return a.second > b.second;
+		});
+
+		/* Cut if have too many influencing bones, zero pad if too few */
+		finals.resize(BU_MAX_INFLUENCING_BONE, make_pair(0, 0.0f));
+
+		/* Normalize weights
+		*  In Blender, weight painting produces weights in [0.0, 1.0] for individual Bone irregardless of other Bone weights.
+		*  Thus painting multiple Bones produces multiple weights, each in [0.0, 1.0].
+		*    - Weights have to sum to 1.0
+		*    - influA having the same Blender weight as influB should result in having the same final weight
+		*    - influA having a Blender weight 'n' times as high as InfluB should result in having 'n' times the final weight
+		*  finalWeights = map(lambda x: x / sum(influWeights), influWeights) # Just a division by sum of influences
+		*/
+		float influWeightSum = accumulate(finals.begin(), finals.end(), 0.0f, [](float a, pair<int, float> x) { return a + x.second; });
+		if (!ScaZero(influWeightSum))
+			transform(finals.begin(), finals.end(), finals.begin(), [&influWeightSum](pair<int, float> x) { return make_pair(x.first, x.second / influWeightSum); });
+
+		assert(BU_MAX_INFLUENCING_BONE == finals.size());
+		for (int j = 0; j < BU_MAX_INFLUENCING_BONE; j++) {
+			oId[j] = finals[j].first;
+			oWt[j] = finals[j].second;
+		}
+	}
+
+	/* Only the Header is examined: offsets and counts are bounds checked, the arrays themselves are trusted to be what
+	*  BakeSectionData wrote from a checked SectionDataEx. A foreign or outdated image throws ExcVersion. */
+	static SectionDataBaked * MakeSectionDataBaked(const Slice &image) {
+		typedef SectionDataBaked B;
+		int n = image.size();
+
+		if (n < sizeof(B::Header))
+			throw ExcVersion();
+
+		/* Mappings are page aligned, so is the Header */
+		const B::Header *h = (const B::Header *)image.CharPtrRel(0);
+
+		if (memcmp(h->magic, BU_BAKED_MAGIC, sizeof h->magic) != 0 || h->version != BU_BAKED_VERSION)
+			throw ExcVersion();
+		if (h->byteOrder != 0x01020304 || h->sizeofMat != sizeof(DMat) || h->numRef != B::KindCount)
+			throw ExcVersion();
+		assert(h->lenImage == n);
+
+		const char *ptr[B::KindCount];
+		for (int k = 0; k < B::KindCount; k++) {
+			const B::Ref &r = h->ref[k];
+			assert(r.off >= (int)sizeof(B::Header) && r.off <= n && r.off % BU_DAT_ALIGN == 0);
+			assert(r.count >= 0 && r.count <= (n - r.off) / B::EltSize((B::Kind)k));
+			ptr[k] = image.CharPtrRel(r.off);
+		}
+
+		SectionDataBaked *sd = new SectionDataBaked(image);
+
+		sd->numMesh = h->numMesh;
+		sd->numBone = h->numBone;
+
+		sd->meshNameBeg   = (const int *)ptr[B::MeshNameBeg];
+		sd->meshNameChar  = ptr[B::MeshNameChar];
+		sd->meshParent    = (const int *)ptr[B::MeshParent];
+		sd->meshMatrix    = (const DMat *)ptr[B::MeshMatrix];
+		sd->meshChildBeg  = (const int *)ptr[B::MeshChildBeg];
+		sd->meshChild     = (const int *)ptr[B::MeshChild];
+		sd->meshTopo      = (const int *)ptr[B::MeshTopo];
+
+		sd->boneNameBeg   = (const int *)ptr[B::BoneNameBeg];
+		sd->boneNameChar  = ptr[B::BoneNameChar];
+		sd->boneParent    = (const int *)ptr[B::BoneParent];
+		sd->boneMatrix    = (const DMat *)ptr[B::BoneMatrix];
+		sd->boneInvBind   = (const DMat *)ptr[B::BoneInvBind];
+		sd->boneRestLocal = (const DMat *)ptr[B::BoneRestLocal];
+		sd->boneChildBeg  = (const int *)ptr[B::BoneChildBeg];
+		sd->boneChild     = (const int *)ptr[B::BoneChild];
+		sd->boneTopo      = (const int *)ptr[B::BoneTopo];
+
+		sd->meshPart      = (const B::Part *)ptr[B::MeshPart];
+		sd->meshVert      = (const float *)ptr[B::MeshVert];
+		sd->meshIndex     = (const int *)ptr[B::MeshIndex];
+		sd->meshVertId    = (const int *)ptr[B::MeshVertId];
+		sd->meshVertWt    = (const float *)ptr[B::MeshVertWt];
+
+		CheckSectionDataBaked(*sd, *h);
+
+		return sd;
+	}
+
+	/* Geometry buffers are drawn from 'arena' (if given) so that an asset gets freed in one go once the last of them is gone.
+	*  Parse temporaries (chunk lists) come from a scratch Arena released on return.
+	*  Meshes come out welded (See MeshWeld), unlike MakeSectionDataEx which keeps the file's vertices as they are. */
+	static SectionDataPacked * MakeSectionDataPacked(const P &inP, const shared_ptr<Arena> &arena = shared_ptr<Arena>(), ThreadPool *pool = NULL) {
+		SectionIndex idx;
+
+		if (!ReadSectionToc(inP, &idx))
+			ReadSectionIndex(inP, vector<string>(), &idx);
+
+		unique_ptr<SectionDataPacked> sd(new SectionDataPacked());
+		FillSectionDataPacked(idx, arena, pool, sd.get());
+		CheckSectionDataPacked(*sd);
+
+		return sd.release();
+	}
+
+	static void FillSectionDataHier(const SectionIndex &idx, SectionDataHier *outSD) {
+		FillLenDel(idx.Get("MESHNAME").data, &outSD->meshName);
+		FillInt(idx.Get("MESHPARENT").data, &outSD->meshParent);
+		FillMat(idx.Get("MESHMATRIX").data, &outSD->meshMatrix);
+
+		FillLenDel(idx.Get("BONENAME").data, &outSD->boneName);
+		FillInt(idx.Get("BONEPARENT").data, &outSD->boneParent);
+		FillMat(idx.Get("BONEMATRIX").data, &outSD->boneMatrix);
+
+		if (idx.Exist("BONEINVBIND"))
+			FillMat(idx.Get("BONEINVBIND").data, &outSD->boneInvBind);
+		else
+			FillBoneInvBind(outSD->boneMatrix, &outSD->boneInvBind);
+
+		assert(outSD->boneName.size() <= BU_MAX_TOTAL_BONE_PER_MESH);
+
+		FillChild(outSD->meshParent, &outSD->meshChild);
+		FillChild(outSD->boneParent, &outSD->boneChild);
+
+		FillTopo("mesh", outSD->meshParent, outSD->meshChild, &outSD->meshTopo);
+		FillTopo("bone", outSD->boneParent, outSD->boneChild, &outSD->boneTopo);
+
+		FillBoneRestLocal(outSD);
+		FillAnim(idx, &outSD->anim);
+	}
+
+	static void FillSectionDataPacked(const SectionIndex &idx, const shared_ptr<Arena> &arena, ThreadPool *pool, SectionDataPacked *outSD) {
+		Arena scratch;
+
+		FillSectionDataHier(idx, outSD);
+
+		int numMesh = outSD->meshName.size();
+
+		vector<Slice, ArenaAllocator<Slice> > mVertChunks((ArenaAllocator<Slice>(&scratch)));
+		vector<Slice, ArenaAllocator<Slice> > mIndexChunks((ArenaAllocator<Slice>(&scratch)));
+		vector<Slice, ArenaAllocator<Slice> > mBWChunks((ArenaAllocator<Slice>(&scratch)));
+		vector<int> mBWBase;
+		mMeshChunks(idx, numMesh, &mVertChunks, &mIndexChunks, &mBWChunks, &mBWBase);
+
+		const int K = BU_MAX_INFLUENCING_BONE;
+
+		/* Vertices are decoded into scratch and welded (See MeshWeldRemap) first, the packed slices are sized from the
+		*  welded counts. Scratch is carved out up front as the Arena is not for concurrent use. */
+		vector<int> numVertIn(numMesh), cntIndex(numMesh);
+		size_t scratchBytes = 0;
+		for (int m = 0; m < numMesh; m++) {
+			numVertIn[m] = mNumVertFromSize(mVertChunks[m].size() / 4);
+			cntIndex[m]  = mIndexChunks[m].size() / 4;
+			assert(cntIndex[m] % 3 == 0);
+			scratchBytes += mScratchBytes(3 * numVertIn[m]) + 2 * mScratchBytes(K * numVertIn[m]) + mScratchBytes(numVertIn[m]) +
+				mScratchBytes(MeshWeldTableSize(numVertIn[m]));
+		}
+		scratch.Reserve(scratchBytes);
+
+		vector<float *> sVert(numMesh), sVertWt(numMesh);
+		vector<int *> sVertId(numMesh), sRemap(numMesh), sTable(numMesh);
+		for (int m = 0; m < numMesh; m++) {
+			sVert[m]   = (float *)scratch.Alloc(mScratchBytes(3 * numVertIn[m]));
+			sVertId[m] = (int *)scratch.Alloc(mScratchBytes(K * numVertIn[m]));
+			sVertWt[m] = (float *)scratch.Alloc(mScratchBytes(K * numVertIn[m]));
+			sRemap[m]  = (int *)scratch.Alloc(mScratchBytes(numVertIn[m]));
+			sTable[m]  = (int *)scratch.Alloc(mScratchBytes(MeshWeldTableSize(numVertIn[m])));
+		}
+
+		vector<int> numVertOut(numMesh);
+
+		/* Meshes are independent - each task touches only its own mesh's part */
+		ParallelFor(pool, numMesh, [&](int m) {
+			int numVert = numVertIn[m];
+			if (!numVert)
+				return;
+			P(mVertChunks[m]).ReadBulk32(sVert[m], 3 * numVert);
+			mFillVertWeightBatch(&mBWChunks[mBWBase[m]], numVert, sVertId[m], sVertWt[m]);
+			numVertOut[m] = MeshWeldRemap(sVert[m], sVertId[m], sVertWt[m], numVert, sTable[m], sRemap[m]);
+		});
+
+		vector<int> cntVert(numMesh), cntWeight(numMesh);
+		for (int m = 0; m < numMesh; m++) {
+			cntVert[m]   = 3 * numVertOut[m];
+			cntWeight[m] = K * numVertOut[m];
+		}
+
+		/* One block of exactly the geometry size, the attribute buffers would each get their own otherwise */
+		if (arena)
+			arena->Reserve(PackedAttr<float>::Bytes(cntVert) + PackedAttr<int>::Bytes(cntIndex) +
+				PackedAttr<int>::Bytes(cntWeight) + PackedAttr<float>::Bytes(cntWeight));
+
+		outSD->meshVert.Alloc(cntVert, arena);
+		outSD->meshIndex.Alloc(cntIndex, arena);
+		outSD->meshVertId.Alloc(cntWeight, arena);
+		outSD->meshVertWt.Alloc(cntWeight, arena);
+
+		/* Survivors go straight from scratch to their slot, indices are decoded into place and renumbered there */
+		ParallelFor(pool, numMesh, [&](int m) {
+			float *vert   = outSD->meshVert.Ptr(m);
+			int   *vertId = outSD->meshVertId.Ptr(m);
+			float *vertWt = outSD->meshVertWt.Ptr(m);
+			int   *index  = outSD->meshIndex.Ptr(m);
+
+			for (int v = 0, k = 0; v < numVertIn[m]; v++) {
+				if (sRemap[m][v] != k)
+					continue;
+				memcpy(vert + 3 * k, sVert[m] + 3 * v, 3 * sizeof(float));
+				memcpy(vertId + K * k, sVertId[m] + K * v, K * sizeof(int));
+				memcpy(vertWt + K * k, sVertWt[m] + K * v, K * sizeof(float));
+				k++;
+			}
+
+			P(mIndexChunks[m]).ReadBulk32(index, cntIndex[m]);
+			for (int j = 0; j < cntIndex[m]; j++) {
+				assert(P::CheckIntArbitraryLimit(index[j]));
+				assert(index[j] >= 0 && index[j] < numVertIn[m]);
+				index[j] = sRemap[m][index[j]];
+			}
+		});
+	}
+
+	/* Scratch request of 'n' 4 byte elements, a BlockAlign multiple so that Arena::Reserve covers a run of them exactly */
+	static size_t mScratchBytes(int n) {
+		return ((size_t)n * 4 + Arena::BlockAlign - 1) & ~(size_t)(Arena::BlockAlign - 1);
+	}
+
+	static void CheckSectionData(const SectionData &sd) {
+		int numMesh = sd.meshName.size();
+		int numBone = sd.boneName.size();
+
+		CheckSectionDataHier(sd);
+
+		assert(numMesh == sd.meshVert.size());
+
+		for (int i = 0; i < numMesh; i++) {
+			int numVert = mNumVertFromSize(sd.meshVert[i].size());
+
+			assert(sd.meshVertId[i].size() == BU_MAX_INFLUENCING_BONE * numVert);
+			assert(sd.meshVertWt[i].size() == BU_MAX_INFLUENCING_BONE * numVert);
+
+			for (auto &j : sd.meshVertId[i])
+				assert(j >= 0 && j < numBone);
+			for (auto &j : sd.meshVertWt[i])
+				assert(j >= 0.0 && j <= 1.0);
+		}
+	}
+
+	static void CheckSectionDataPacked(const SectionDataPacked &sd) {
+		int numMesh = sd.meshName.size();
+		int numBone = sd.boneName.size();
 
-		assert(outSD->boneName.size() <= BU_MAX_TOTAL_BONE_PER_MESH);
+		CheckSectionDataHier(sd);
 
-		{
-			vector<string>         mVertChunks;
-			vector<vector<float> > mVert;
-			FillLenDel(SectionGetByName(sec, "MESHVERT").data, &mVertChunks);
-			for (int i = 0; i < mVertChunks.size(); i++) {
-				vector<float> v;
-				FillFloat(Slice(slice_str_t(), mVertChunks[i]), &v);
-				assert(v.size() % 3 == 0);
-				mVert.push_back(v);
-			}
-			outSD->meshVert = mVert;
-		}
+		assert(numMesh == sd.meshVert.NumPart());
+		assert(numMesh == sd.meshIndex.NumPart());
 
-		{
-			vector<string>       mIndexChunks;
-			vector<vector<int> > mIndex;
-			FillLenDel(SectionGetByName(sec, "MESHINDEX").data, &mIndexChunks);
-			for (int i = 0; i < mIndexChunks.size(); i++) {
-				vector<int> v;
-				FillInt(Slice(slice_str_t(), mIndexChunks[i]), &v);
-				assert(v.size() % 3 == 0);
-				mIndex.push_back(v);
-			}
-			outSD->meshIndex = mIndex;
-		}
+		for (int i = 0; i < numMesh; i++) {
+			int numVert = mNumVertFromSize(sd.meshVert.Count(i));
 
-		{
-			int numMesh = outSD->meshName.size();
-
-			vector<vector<int> > mVBWeightId;
-			vector<vector<float> > mVBWeightWt;
-
-			vector<string> mBWChunks;
-			FillLenDel(SectionGetByName(sec, "MESHVERTBONEWEIGHT").data, &mBWChunks);
-			/* MESHVERTBONEWEIGHT stored as flat (MeshN x VertOfMeshN) -> [pairIdWt, ...]
-			*  Accumulate-skip numVert[MeshN] entries to get to Mesh_{N+1} data. */
-			assert(mBWChunks.size() == accumulate(outSD->meshVert.begin(), outSD->meshVert.end(), 0, [](int a, const vector<float> &x) { return a + mNumVertFromSize(x.size()); }));
-
-			mVBWeightId = vector<vector<int> >(numMesh);
-			mVBWeightWt = vector<vector<float> >(numMesh);
-			for (int i = 0; i < numMesh; i++) {
-				int numVert = mNumVertFromSize(outSD->meshVert[i].size());
-				mVBWeightId[i] = vector<int>(BU_MAX_INFLUENCING_BONE * numVert);
-				mVBWeightWt[i] = vector<float>(BU_MAX_INFLUENCING_BONE * numVert);
-			}
-
-			int currBaseIdx = 0;
-			for (int m = 0; m < numMesh; m++) {
-				int numVert = mNumVertFromSize(outSD->meshVert[m].size());
-				for (int i = 0; i < numVert; i++) {
-					vector<pair<int, float> > v;
-					FillPairIntFloat(Slice(slice_str_t(), mBWChunks[currBaseIdx + i]), &v);
-
-					vector<pair<int, float> > finals = v;
-
-					/* Sort by Descending weight */
-					sort(finals.begin(), finals.end(),
-						[](const pair<int, float> &a, const pair<int, float> &b) {
-							/* FIXME: Floating point comparison sync alert */
-							return a.second > b.second;
-					});
-
-					/* Cut if have too many influencing bones, zero pad if too few */
-					finals.resize(BU_MAX_INFLUENCING_BONE, make_pair(0, 0.0f));
-
-					/* Normalize weights
-					*  In Blender, weight painting produces weights in [0.0, 1.0] for individual Bone irregardless of other Bone weights.
-					*  Thus painting multiple Bones produces multiple weights, each in [0.0, 1.0].
-					*    - Weights have to sum to 1.0
-					*    - influA having the same Blender weight as influB should result in having the same final weight
-					*    - influA having a Blender weight 'n' times as high as InfluB should result in having 'n' times the final weight
-					*  finalWeights = map(lambda x: x / sum(influWeights), influWeights) # Just a division by sum of influences
-					*/
-					float influWeightSum = accumulate(finals.begin(), finals.end(), 0.0f, [](float a, pair<int, float> x) { return a + x.second; });
-					if (!ScaZero(influWeightSum))
-						transform(finals.begin(), finals.end(), finals.begin(), [&influWeightSum](pair<int, float> x) { return make_pair(x.first, x.second / influWeightSum); });
-
-					assert(BU_MAX_INFLUENCING_BONE == finals.size());
-					for (int j = 0; j < BU_MAX_INFLUENCING_BONE; j++) {
-						mVBWeightId[m][(BU_MAX_INFLUENCING_BONE * i) + j] = finals[j].first;
-						mVBWeightWt[m][(BU_MAX_INFLUENCING_BONE * i) + j] = finals[j].second;
-					}
-				}
-				currBaseIdx += numVert;
-			}
+			assert(sd.meshVertId.Count(i) == BU_MAX_INFLUENCING_BONE * numVert);
+			assert(sd.meshVertWt.Count(i) == BU_MAX_INFLUENCING_BONE * numVert);
 
-			outSD->meshVertId = mVBWeightId;
-			outSD->meshVertWt = mVBWeightWt;
+			for (int j = 0; j < sd.meshVertId.Count(i); j++)
+				assert(sd.meshVertId.Ptr(i)[j] >= 0 && sd.meshVertId.Ptr(i)[j] < numBone);
+			for (int j = 0; j < sd.meshVertWt.Count(i); j++)
+				assert(sd.meshVertWt.Ptr(i)[j] >= 0.0 && sd.meshVertWt.Ptr(i)[j] <= 1.0);
 		}
+	}
 
-		FillChild(outSD->meshParent, &outSD->meshChild);
-		FillChild(outSD->boneParent, &outSD->boneChild);
+	/* O(numMesh) - array lengths against the counts, CSR ends and mesh parts within their arrays */
+	static void CheckSectionDataBaked(const SectionDataBaked &sd, const SectionDataBaked::Header &h) {
+		typedef SectionDataBaked B;
+		int numMesh = sd.numMesh;
+		int numBone = sd.numBone;
+
+		assert(numMesh > 0 && numBone > 0);
+
+		assert(h.ref[B::MeshNameBeg].count == numMesh + 1 && sd.meshNameBeg[numMesh] == h.ref[B::MeshNameChar].count);
+		assert(h.ref[B::MeshParent].count == numMesh && h.ref[B::MeshMatrix].count == numMesh && h.ref[B::MeshTopo].count == numMesh);
+		assert(h.ref[B::MeshChildBeg].count == numMesh + 1 && sd.meshChildBeg[numMesh] == h.ref[B::MeshChild].count);
+
+		assert(h.ref[B::BoneNameBeg].count == numBone + 1 && sd.boneNameBeg[numBone] == h.ref[B::BoneNameChar].count);
+		assert(h.ref[B::BoneParent].count == numBone && h.ref[B::BoneMatrix].count == numBone && h.ref[B::BoneTopo].count == numBone);
+		assert(h.ref[B::BoneInvBind].count == numBone && h.ref[B::BoneRestLocal].count == numBone);
+		assert(h.ref[B::BoneChildBeg].count == numBone + 1 && sd.boneChildBeg[numBone] == h.ref[B::BoneChild].count);
+
+		assert(h.ref[B::MeshPart].count == numMesh);
+		assert(h.ref[B::MeshVertId].count == h.ref[B::MeshVertWt].count);
+		for (int m = 0; m < numMesh; m++) {
+			const B::Part &p = sd.meshPart[m];
+			assert(p.vertOff >= 0 && p.vertCount >= 0 && p.vertOff + p.vertCount <= h.ref[B::MeshVert].count && p.vertCount % 3 == 0);
+			assert(p.indexOff >= 0 && p.indexCount >= 0 && p.indexOff + p.indexCount <= h.ref[B::MeshIndex].count);
+			assert(p.weightOff >= 0 && p.weightCount == BU_MAX_INFLUENCING_BONE * (p.vertCount / 3) && p.weightOff + p.weightCount <= h.ref[B::MeshVertId].count);
+		}
 	}
 
-	static void CheckSectionData(const SectionData &sd) {
+	static void CheckSectionDataHier(const SectionDataHier &sd) {
 		int numMesh = sd.meshName.size();
 		int numBone = sd.boneName.size();
 
@@ -667,7 +4157,8 @@ public:
 			assert(i.size());
 		for (auto &i : sd.meshParent)
 			assert(i == -1 || (i >= 0 && i < numMesh));
-		assert(!IsCycle(sd.meshParent));
+		/* Filled only by a successful HierarchyValidate (no cycles, all reachable) */
+		assert(numMesh == sd.meshTopo.size());
 		assert(numMesh == sd.meshMatrix.size());
 
 		assert(numBone);
@@ -677,22 +4168,166 @@ public:
 			assert(i.size());
 		for (auto &i : sd.boneParent)
 			assert(i == -1 || (i >= 0 && i < numBone));
-		assert(!IsCycle(sd.boneParent));
+		assert(numBone == sd.boneTopo.size());
 		assert(numBone == sd.boneMatrix.size());
+		assert(numBone == sd.boneInvBind.size());
+		assert(numBone == sd.boneRestLocal.size());
+
+		for (auto &a : sd.anim)
+			for (auto &c : a.channel) {
+				assert(c.bone >= 0 && c.bone < numBone);
+				if (c.keyOff >= 0)
+					assert(c.track[AnimLoc].numKey >= 1 && c.keyOff + c.track[AnimLoc].numKey <= a.key.size());
+				for (int j = 0; j < AnimTrackCount; j++) {
+					const AnimTrack &tr = c.track[j];
+					assert(tr.numKey >= 0 && tr.valOff >= 0);
+					if (c.keyOff >= 0)
+						assert(tr.numKey == c.track[AnimLoc].numKey && tr.timeOff == c.track[AnimLoc].timeOff);
+					else
+						assert(tr.valOff + 3 * tr.numKey <= (j == AnimRot ? a.rot.size() : a.vec.size()));
+					if (tr.numKey < 2)
+						continue;
+					assert(tr.timeOff >= 0 && tr.timeOff + tr.numKey <= a.time.size());
+					for (int k = 1; k < tr.numKey; k++)
+						assert(a.time[tr.timeOff + k - 1] < a.time[tr.timeOff + k]);
+				}
+			}
+	}
 
-		assert(numMesh == sd.meshVert.size());
+	/* Needs boneTopo; left empty when the hierarchy failed validation */
+	static void FillBoneRestLocal(SectionDataHier *outSD) {
+		int numBone = outSD->boneName.size();
 
-		for (int i = 0; i < numMesh; i++) {
-			int numVert = mNumVertFromSize(sd.meshVert[i].size());
+		outSD->boneRestLocal.clear();
+		if (outSD->boneTopo.size() != numBone || outSD->boneInvBind.size() != numBone)
+			return;
 
-			assert(sd.meshVertId[i].size() == BU_MAX_INFLUENCING_BONE * numVert);
-			assert(sd.meshVertWt[i].size() == BU_MAX_INFLUENCING_BONE * numVert);
+		outSD->boneRestLocal.resize(numBone);
+		for (int b = 0; b < numBone; b++) {
+			int p = outSD->boneParent[b];
+			outSD->boneRestLocal[b] = p == -1 ? outSD->boneMatrix[b] : DMat::Multiply(outSD->boneInvBind[p], outSD->boneMatrix[b]);
+		}
+	}
 
-			for (auto &j : sd.meshVertId[i])
-				assert(j >= 0 && j < numBone);
-			for (auto &j : sd.meshVertWt[i])
-				assert(j >= 0.0 && j <= 1.0);
+	/* ANIMNAME:     LenDel clip names
+	*  ANIMCHAN:     int (clip, bone) per channel
+	*  ANIMCHANTIME: per channel LenDel [float time]*, ascending seconds
+	*  ANIMCHANTRS:  per channel LenDel [float tx ty tz qx qy qz qw sx sy sz]* matching the times
+	*  ANIMCHANPACK: replaces the two above when present, per channel LenDel compressed tracks (See FillAnimChanPack) */
+	static void FillAnim(const SectionIndex &idx, vector<AnimClip> *outAnim) {
+		outAnim->clear();
+		if (!idx.Exist("ANIMNAME"))
+			return;
+
+		vector<string> name;
+		vector<int>    chan;
+		vector<Slice>  timeChunks, trsChunks, packChunks;
+		FillLenDel(idx.Get("ANIMNAME").data, &name);
+		FillInt(idx.Get("ANIMCHAN").data, &chan);
+
+		bool pack = idx.Exist("ANIMCHANPACK");
+		if (pack) {
+			FillLenDelSlice(idx.Get("ANIMCHANPACK").data, &packChunks);
+		} else {
+			FillLenDelSlice(idx.Get("ANIMCHANTIME").data, &timeChunks);
+			FillLenDelSlice(idx.Get("ANIMCHANTRS").data, &trsChunks);
+		}
+
+		int numChan = chan.size() / 2;
+		assert(chan.size() % 2 == 0);
+		assert(pack ? packChunks.size() == numChan : timeChunks.size() == numChan && trsChunks.size() == numChan);
+
+		vector<AnimClip> anim(name.size());
+		for (int i = 0; i < name.size(); i++) {
+			anim[i].name = name[i];
+			anim[i].duration = 0.0f;
+		}
+
+		vector<float> trs;
+		vector<DTrs>  key;
+		for (int c = 0; c < numChan; c++) {
+			int clip = chan[2 * c + 0];
+			int bone = chan[2 * c + 1];
+			assert(clip >= 0 && clip < anim.size());
+
+			if (pack) {
+				FillAnimChanPack(packChunks[c], bone, &anim[clip]);
+				continue;
+			}
+
+			vector<float> time;
+			FillFloat(timeChunks[c], &time);
+			FillFloat(trsChunks[c], &trs);
+			assert(time.size() && trs.size() == 10 * time.size());
+
+			key.resize(time.size());
+			for (int k = 0; k < time.size(); k++) {
+				const float *v = &trs[10 * k];
+				DTrs &o = key[k];
+				o.t[0] = v[0]; o.t[1] = v[1]; o.t[2] = v[2]; o.t[3] = 0.0f;
+				o.r[0] = v[3]; o.r[1] = v[4]; o.r[2] = v[5]; o.r[3] = v[6];
+				o.s[0] = v[7]; o.s[1] = v[8]; o.s[2] = v[9]; o.s[3] = 0.0f;
+			}
+
+			AnimClipAddChannel(&anim[clip], bone, &time[0], &key[0], time.size());
+		}
+
+		outAnim->swap(anim);
+	}
+
+	/* Location, rotation and scale tracks, each:
+	*    int numKey   0: identity default, 1: constant, n: linearly reduced keys
+	*    float time*  numKey of them, only when numKey > 1
+	*    value*       location and scale 3 floats, rotation 6 bytes smallest-three (See QuatSmallest3Decode)
+	*  Appended to the clip pools as they are, AnimSampler interpolates the tracks independently. */
+	static void FillAnimChanPack(const Slice &chunk, int bone, AnimClip *outClip) {
+		AnimChannel ch;
+		ch.bone   = bone;
+		ch.keyOff = -1;
+
+		P w(chunk);
+
+		for (int j = 0; j < AnimTrackCount; j++) {
+			AnimTrack &tr = ch.track[j];
+			tr.numKey  = w.ReadInt();
+			tr.timeOff = outClip->time.size();
+			tr.valOff  = j == AnimRot ? outClip->rot.size() : outClip->vec.size();
+			assert(tr.numKey >= 0 && P::CheckIntArbitraryLimit(tr.numKey));
+
+			if (tr.numKey > 1) {
+				outClip->time.resize(tr.timeOff + tr.numKey);
+				w.ReadBulk32(&outClip->time[tr.timeOff], tr.numKey);
+				outClip->duration = max(outClip->duration, outClip->time.back());
+			}
+
+			if (j == AnimRot) {
+				outClip->rot.resize(tr.valOff + 3 * tr.numKey);
+				for (int k = 0; k < tr.numKey; k++)
+					ReadQuatSmallest3(&w, &outClip->rot[tr.valOff + 3 * k]);
+			} else {
+				outClip->vec.resize(tr.valOff + 3 * tr.numKey);
+				if (tr.numKey)
+					w.ReadBulk32(&outClip->vec[tr.valOff], 3 * tr.numKey);
+			}
 		}
+		assert(w.BytesLeft() == 0);
+
+		outClip->channel.push_back(ch);
+	}
+
+	/* 48 bits little endian into the three uint16_t of QuatSmallest3Decode */
+	static void ReadQuatSmallest3(P *w, uint16_t *oQ) {
+		unsigned char b[6];
+		w->ReadBytes(b, 6);
+
+		for (int i = 0; i < 3; i++)
+			oQ[i] = (uint16_t)(b[2 * i] | b[2 * i + 1] << 8);
+	}
+
+	static void FillBoneInvBind(const vector<DMat> &boneMatrix, vector<DMat> *outInvBind) {
+		outInvBind->resize(boneMatrix.size());
+		for (int i = 0; i < boneMatrix.size(); i++)
+			(*outInvBind)[i] = DMat::InvertNs(boneMatrix[i]);
 	}
 
 	static void FillChild(const vector<int> &inParent, vector<vector<int> > *outSD) {
@@ -704,67 +4339,56 @@ public:
 		*outSD = cAcc;	
 	}
 
+	/* Throws ExcHierarchy naming the failing node, so that a broken file is not just a missing ordering */
+	static void FillTopo(const char *hierarchy, const vector<int> &parent, const vector<vector<int> > &child, vector<int> *oTopo) {
+		HierarchyDiag diag = HierarchyValidate(parent, child, oTopo);
+
+		if (!diag.IsOk())
+			throw ExcHierarchy(hierarchy, diag);
+	}
+
 	static int mNumVertFromSize(int nFloats) {
 		assert(nFloats % 3 == 0);
 		return nFloats / 3;
 	}
 
 	static bool IsCycle(const vector<int> &parent) {
-		vector<int> root = mListRootFromParent(parent);
 		vector<vector<int> > child;
 		FillChild(parent, &child);
 
-		/* Worst case of a 'n' element hierarchy is a 'n' element chain. Therefore if depth reaches 'n+1' there has to be a cycle. */
-		try {
-			for (int i = 0; i < root.size(); i++)
-				mCycleDfs(parent, child, parent.size() + 1, 0, root[i]);
-		} catch(ExcRecurseMax &) {
-			return true;
-		}
-
-		return false;
-	}
-
-	static vector<int> mListRootFromParent(const vector<int> &parent) {
-		/* Find roots (-1 parent) */
-		vector<int> root;
-		for (int i = 0; i < parent.size(); i++)
-			if (parent[i] == -1)
-				root.push_back(i);
-		return root;
+		return HierarchyValidate(parent, child).kind == HierarchyDiag::Unreached;
 	}
 
-	static void mCycleDfs(const vector<int> &parent, const vector<vector<int> > &child, const int maxDepth, int depth, int visiting) {
-		if (depth >= maxDepth)
-			throw ExcRecurseMax();
-		for (int i = 0; i < child[visiting].size(); i++)
-			mCycleDfs(parent, child, maxDepth, depth + 1, child[visiting][i]);
-	}
+	/* The Fill{Int,Float,Vec3,Mat} family sizes the output from the Slice length and decodes with a single bulk copy */
 
 	static void FillInt(const Slice &sec, vector<int> *outVS) {
-		int bleft;
 		P w(sec);
 
-		vector<int> vS;
+		assert(w.BytesLeft() % 4 == 0);
 
-		while ((bleft = w.BytesLeft()) != 0) {
-			vS.push_back(w.ReadInt());
-		}
+		vector<int> vS(w.BytesLeft() / 4);
 
-		*outVS = vS;
+		if (vS.size())
+			w.ReadBulk32(&vS[0], vS.size());
+
+		/* Validation pass, kept separate from the copy */
+		for (auto &i : vS)
+			assert(w.CheckIntArbitraryLimit(i));
+
+		outVS->swap(vS);
 	}
 
 	static void FillFloat(const Slice &sec, vector<float> *outVS) {
-		int bleft;
 		P w(sec);
 
-		vector<float> vS;
+		assert(w.BytesLeft() % 4 == 0);
 
-		while ((bleft = w.BytesLeft()) != 0) {
-			vS.push_back(w.ReadFloat());
-		}
+		vector<float> vS(w.BytesLeft() / 4);
 
-		*outVS = vS;
+		if (vS.size())
+			w.ReadBulk32(&vS[0], vS.size());
+
+		outVS->swap(vS);
 	}
 
 	static void FillPairIntFloat(const Slice &sec, vector<pair<int, float> > *outVS) {
@@ -797,74 +4421,901 @@ public:
 		*outVS = vS;
 	}
 
-	static void FillVec3(const Slice &sec, vector<DVec3> *outVS) {
+	/* VS is vector<Slice, Alloc>, the output allocator is used for the result */
+	template<typename VS>
+	static void FillLenDelSlice(const Slice &sec, VS *outVS) {
 		int bleft;
 		P w(sec);
 
-		vector<DVec3> vS;
+		VS vS(outVS->get_allocator());
+
+		/* Counting pass over the length prefixes so that vS is allocated exactly once */
+		{
+			P c(sec);
+			int n = 0;
+			while (c.BytesLeft() != 0) {
+				c.ReadLenDelSlice();
+				n++;
+			}
+			vS.reserve(n);
+		}
 
 		while ((bleft = w.BytesLeft()) != 0) {
-			DVec3 m;
+			vS.push_back(w.ReadLenDelSlice());
+		}
+
+		outVS->swap(vS);
+	}
+
+	static void FillVec3(const Slice &sec, vector<DVec3> *outVS) {
+		P w(sec);
 
-			assert(w.BytesLeft() >= 3*4);
+		assert(sizeof(DVec3) == 3*4);
+		assert(w.BytesLeft() % (3*4) == 0);
 
-			for (int i = 0; i < 3; i++)
-				m.d[i] = w.ReadFloat();
+		vector<DVec3> vS(w.BytesLeft() / (3*4));
 
-			vS.push_back(m);
-		}
+		if (vS.size())
+			w.ReadBulk32(vS[0].d, 3 * vS.size());
 
-		*outVS = vS;
+		outVS->swap(vS);
 	}
 
 	static void FillMat(const Slice &sec, vector<DMat> *outVS) {
-		int bleft;
 		P w(sec);
 
-		vector<DMat> vS;
+		assert(sizeof(DMat) == 16*4);
+		assert(w.BytesLeft() % (16*4) == 0);
 
-		while ((bleft = w.BytesLeft()) != 0) {
-			DMat m;
+		vector<DMat> vS(w.BytesLeft() / (16*4));
+
+		if (vS.size())
+			w.ReadBulk32(vS[0].d, 16 * vS.size());
+
+		outVS->swap(vS);
+	}
+};
+
+/* Lays out the arrays of a baked image one after the other, each 16 byte aligned, and records them in the Header */
+class BakeWriter {
+	string img;
+	SectionDataBaked::Header hdr;
+public:
+	BakeWriter(int numMesh, int numBone) : img(DatAlign(sizeof hdr), '\0') {
+		memset(&hdr, 0, sizeof hdr);
+		memcpy(hdr.magic, BU_BAKED_MAGIC, sizeof hdr.magic);
+		hdr.version   = BU_BAKED_VERSION;
+		hdr.byteOrder = 0x01020304;
+		hdr.sizeofMat = sizeof(DMat);
+		hdr.numMesh   = numMesh;
+		hdr.numBone   = numBone;
+		hdr.numRef    = SectionDataBaked::KindCount;
+	}
+
+	template<typename T>
+	void Put(SectionDataBaked::Kind k, const vector<T> &v) {
+		assert(sizeof(T) == SectionDataBaked::EltSize(k));
 
-			assert(w.BytesLeft() >= 16*4);
+		hdr.ref[k].off   = img.size();
+		hdr.ref[k].count = v.size();
+		if (v.size())
+			img.append((const char *)&v[0], v.size() * sizeof(T));
+		img.resize(DatAlign(img.size()), '\0');
+	}
 
-			for (int i = 0; i < 16; i++)
-				m.d[i] = w.ReadFloat();
+	void Finish(string *oImage) {
+		hdr.lenImage = img.size();
+		memcpy(&img[0], &hdr, sizeof hdr);
+		oImage->swap(img);
+	}
 
-			vS.push_back(m);
+	static void Csr(const vector<vector<int> > &v, vector<int> *oBeg, vector<int> *oFlat) {
+		oBeg->assign(1, 0);
+		oFlat->clear();
+		for (auto &i : v) {
+			oFlat->insert(oFlat->end(), i.begin(), i.end());
+			oBeg->push_back(oFlat->size());
 		}
+	}
 
-		*outVS = vS;
+	static void Csr(const vector<string> &v, vector<int> *oBeg, vector<char> *oFlat) {
+		oBeg->assign(1, 0);
+		oFlat->clear();
+		for (auto &i : v) {
+			oFlat->insert(oFlat->end(), i.begin(), i.end());
+			oBeg->push_back(oFlat->size());
+		}
+	}
+
+	/* Appends 'part' to 'flat' at a 16 byte aligned element offset (T is 4 bytes), returns the offset */
+	template<typename T>
+	static int AppendAligned(const vector<T> &part, vector<T> *flat) {
+		int off = flat->size();
+		flat->insert(flat->end(), part.begin(), part.end());
+		flat->resize(DatAlign(flat->size() * sizeof(T)) / sizeof(T), T());
+		return off;
 	}
 };
 
-P * MakePFromFile(const string &fname) {
-	int r;
-	char buf[1024];
-	string acc;
-	FILE *f;
+/* Everything the loaders compute (normalised 4-bone weights, child lists, topological orders, inverse bind and rest
+*  matrices) goes in as is, so that SectionDataBaked needs no processing. Meshes start 16 byte aligned in each array. */
+void BakeSectionData(const SectionDataEx &sd, string *oImage) {
+	typedef SectionDataBaked B;
+	int numMesh = sd.meshName.size();
+	int numBone = sd.boneName.size();
+	BakeWriter w(numMesh, numBone);
+
+	vector<int>  beg, flat;
+	vector<char> chr;
+
+	BakeWriter::Csr(sd.meshName, &beg, &chr);
+	w.Put(B::MeshNameBeg, beg);
+	w.Put(B::MeshNameChar, chr);
+	w.Put(B::MeshParent, sd.meshParent);
+	w.Put(B::MeshMatrix, sd.meshMatrix);
+	BakeWriter::Csr(sd.meshChild, &beg, &flat);
+	w.Put(B::MeshChildBeg, beg);
+	w.Put(B::MeshChild, flat);
+	w.Put(B::MeshTopo, sd.meshTopo);
+
+	BakeWriter::Csr(sd.boneName, &beg, &chr);
+	w.Put(B::BoneNameBeg, beg);
+	w.Put(B::BoneNameChar, chr);
+	w.Put(B::BoneParent, sd.boneParent);
+	w.Put(B::BoneMatrix, sd.boneMatrix);
+	w.Put(B::BoneInvBind, sd.boneInvBind);
+	w.Put(B::BoneRestLocal, sd.boneRestLocal);
+	BakeWriter::Csr(sd.boneChild, &beg, &flat);
+	w.Put(B::BoneChildBeg, beg);
+	w.Put(B::BoneChild, flat);
+	w.Put(B::BoneTopo, sd.boneTopo);
+
+	vector<B::Part> part(numMesh);
+	vector<float> vert, wt;
+	vector<int>   index, id;
+	for (int m = 0; m < numMesh; m++) {
+		part[m].vertOff     = BakeWriter::AppendAligned(sd.meshVert[m], &vert);
+		part[m].vertCount   = sd.meshVert[m].size();
+		part[m].indexOff    = BakeWriter::AppendAligned(sd.meshIndex[m], &index);
+		part[m].indexCount  = sd.meshIndex[m].size();
+		part[m].weightOff   = BakeWriter::AppendAligned(sd.meshVertId[m], &id);
+		part[m].weightCount = sd.meshVertId[m].size();
+		BakeWriter::AppendAligned(sd.meshVertWt[m], &wt);
+	}
+	w.Put(B::MeshPart, part);
+	w.Put(B::MeshVert, vert);
+	w.Put(B::MeshIndex, index);
+	w.Put(B::MeshVertId, id);
+	w.Put(B::MeshVertWt, wt);
 
-	f = fopen(fname.c_str(), "rb");
-	assert(f);
+	w.Finish(oImage);
+}
 
-	while ((r = fread(buf, 1, 1024, f)))
-		acc.append(buf, r);
+P * MakePFromFile(const string &fname) {
+	/* Parsing runs directly over the read-only mapping; pages are touched only as sections get decoded. */
+	shared_ptr<MMapFile> m(new MMapFile(fname));
 
-	assert(!ferror(f));
-	assert(feof(f));
+	return new P(Slice(slice_mmap_t(), m));
+}
 
-	fclose(f);
+SectionDataEx * BlendUtilMakeSectionDataEx(const string &fName, ThreadPool *pool = NULL) {
+	shared_ptr<P> p(MakePFromFile(fName.c_str()));
+	SectionDataEx *sd = Parse::MakeSectionDataEx(*p, pool);
 
-	return new P(acc);
+	return sd;
 }
 
-SectionDataEx * BlendUtilMakeSectionDataEx(const string &fName) {
+SectionDataPacked * BlendUtilMakeSectionDataPacked(const string &fName, ThreadPool *pool = NULL) {
 	shared_ptr<P> p(MakePFromFile(fName.c_str()));
-	SectionDataEx *sd = Parse::MakeSectionDataEx(*p);
+	/* Parse::FillSectionDataPacked reserves the geometry block from the decoded counts, no slack to size for here */
+	shared_ptr<Arena> arena(new Arena());
+	SectionDataPacked *sd = Parse::MakeSectionDataPacked(*p, arena, pool);
+
+	return sd;
+}
+
+SectionDataBaked * BlendUtilMakeSectionDataBaked(const string &fName) {
+	shared_ptr<MMapFile> m(new MMapFile(fName));
+
+	return Parse::MakeSectionDataBaked(Slice(slice_mmap_t(), m));
+}
+
+/* With 'optimize' the meshes go through MeshWeld and MeshOptimize first */
+void BlendUtilBake(const string &fIn, const string &fOut, bool optimize = false) {
+	shared_ptr<SectionDataEx> sd(BlendUtilMakeSectionDataEx(fIn));
+	if (optimize) {
+		MeshWeld(sd.get());
+		MeshOptimize(sd.get());
+	}
+	string img;
+	BakeSectionData(*sd, &img);
+
+	FILE *f = fopen(fOut.c_str(), "wb");
+	if (!f)
+		throw ExcFileOpen();
+	int r = fwrite(img.data(), 1, img.size(), f);
+	assert(r == img.size());
+	fclose(f);
+}
+
+SectionDataEx * BlendUtilMakeSectionDataExStream(const string &fName) {
+	/* Arbitrary bound on sections read ahead of the decoder */
+	SectionPipeline pipe(fName, 16 * 1024 * 1024);
+	SectionDataEx *sd = Parse::MakeSectionDataExStream(&pipe);
 
 	return sd;
 }
 
+class BatchResult {
+public:
+	string fname;
+	shared_ptr<SectionDataEx> sd;
+	/* Empty on success, sd is NULL otherwise */
+	string error;
+};
+
+/* Loads every file of 'fnames' over 'pool' (serially if NULL), one task per file.
+*  Mesh decoding inside each file is spread over the same pool, so a few large files still use all workers.
+*  A file failing to open, missing a section or with a broken hierarchy is reported in its BatchResult and does not stop the others.
+*  (A v2 file with a damaged section header or payload is reported as a checksum mismatch, corrupt v1 section contents still trip the asserts in P.) */
+vector<BatchResult> BlendUtilMakeSectionDataExBatch(const vector<string> &fnames, ThreadPool *pool) {
+	vector<BatchResult> ret(fnames.size());
+
+	ParallelFor(pool, fnames.size(), [&](int i) {
+		ret[i].fname = fnames[i];
+		try {
+			ret[i].sd = shared_ptr<SectionDataEx>(BlendUtilMakeSectionDataEx(fnames[i], pool));
+		} catch (ExcFileOpen &) {
+			ret[i].error = "cannot open file";
+		} catch (ExcItemExist &) {
+			ret[i].error = "missing section";
+		} catch (ExcChecksum &) {
+			ret[i].error = "checksum mismatch";
+		} catch (ExcVersion &) {
+			ret[i].error = "unsupported version";
+		} catch (ExcHierarchy &e) {
+			char node[16];
+			sprintf(node, "%d", e.diag.node);
+			ret[i].error = string("bad ").append(e.hierarchy).append(" hierarchy at node ").append(node).append(": ").append(e.diag.What());
+		} catch (exception &e) {
+			ret[i].error = string(typeid(e).name()).append(": ").append(e.what());
+		}
+	});
+
+	return ret;
+}
+
+vector<string> ListDirDat(const string &dir) {
+	vector<string> ret;
+	const string ext(".dat");
+#ifdef _WIN32
+	WIN32_FIND_DATAA fd;
+	HANDLE h = FindFirstFileA((dir + "\\*.dat").c_str(), &fd);
+	if (h == INVALID_HANDLE_VALUE)
+		return ret;
+	do {
+		if (!(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+			ret.push_back(dir + "\\" + fd.cFileName);
+	} while (FindNextFileA(h, &fd));
+	FindClose(h);
+#else
+	DIR *d = opendir(dir.c_str());
+	if (!d)
+		return ret;
+	struct dirent *e;
+	while ((e = readdir(d))) {
+		string name(e->d_name);
+		if (name.size() > ext.size() && name.compare(name.size() - ext.size(), ext.size(), ext) == 0)
+			ret.push_back(dir + "/" + name);
+	}
+	closedir(d);
+#endif
+	sort(ret.begin(), ret.end());
+	return ret;
+}
+
+/* CLI: load every .dat in 'dir' as a batch and print per-file errors and throughput */
+void BlendUtilRunBatch(const string &dir, int numThread) {
+	vector<string> fnames = ListDirDat(dir);
+
+	ThreadPool pool(numThread);
+
+	chrono::high_resolution_clock::time_point t0 = chrono::high_resolution_clock::now();
+	vector<BatchResult> res = BlendUtilMakeSectionDataExBatch(fnames, &pool);
+	chrono::high_resolution_clock::time_point t1 = chrono::high_resolution_clock::now();
+
+	double sec = chrono::duration_cast<chrono::duration<double> >(t1 - t0).count();
+
+	int numOk = 0;
+	long long bytes = 0;
+	for (auto &i : res) {
+		if (i.error.size()) {
+			printf("%s: %s\n", i.fname.c_str(), i.error.c_str());
+			continue;
+		}
+		numOk++;
+		bytes += MMapFile(i.fname).Size();
+	}
+
+	printf("Batch %d files (%d failed), %d threads: %.3f s, %.1f files/s, %.1f MB/s\n",
+		(int)res.size(), (int)res.size() - numOk, pool.NumThread(), sec, res.size() / sec, bytes / sec / (1024 * 1024));
+}
+
+/* CLI: bake 'fIn' into 'fOut', then load both ways, compare the geometry and report the load times */
+void BlendUtilRunBake(const string &fIn, const string &fOut, bool optimize) {
+	BlendUtilBake(fIn, fOut, optimize);
+
+	chrono::high_resolution_clock::time_point t0 = chrono::high_resolution_clock::now();
+	shared_ptr<SectionDataEx> sd(BlendUtilMakeSectionDataEx(fIn));
+	chrono::high_resolution_clock::time_point t1 = chrono::high_resolution_clock::now();
+	shared_ptr<SectionDataBaked> sb(BlendUtilMakeSectionDataBaked(fOut));
+	chrono::high_resolution_clock::time_point t2 = chrono::high_resolution_clock::now();
+
+	if (optimize) {
+		MeshWeld(sd.get());
+		MeshOptimize(sd.get());
+	}
+
+	bool same = sb->numMesh == sd->meshName.size() && sb->numBone == sd->boneName.size();
+	for (int m = 0; same && m < sb->numMesh; m++) {
+		same = same && sb->MeshName(m) == sd->meshName[m] && sb->NumVert(m) * 3 == sd->meshVert[m].size();
+		same = same && sb->meshPart[m].indexCount == sd->meshIndex[m].size();
+		if (!same)
+			break;
+		int numVert = sb->NumVert(m);
+		same = same && memcmp(sb->Vert(m), sd->meshVert[m].data(), 3 * numVert * sizeof(float)) == 0;
+		same = same && memcmp(sb->Index(m), sd->meshIndex[m].data(), sd->meshIndex[m].size() * sizeof(int)) == 0;
+		same = same && memcmp(sb->VertId(m), sd->meshVertId[m].data(), BU_MAX_INFLUENCING_BONE * numVert * sizeof(int)) == 0;
+		same = same && memcmp(sb->VertWt(m), sd->meshVertWt[m].data(), BU_MAX_INFLUENCING_BONE * numVert * sizeof(float)) == 0;
+	}
+	for (int b = 0; same && b < sb->numBone; b++)
+		same = sb->BoneName(b) == sd->boneName[b] && sb->boneParent[b] == sd->boneParent[b] && sb->boneTopo[b] == sd->boneTopo[b] &&
+			memcmp(&sb->boneInvBind[b], &sd->boneInvBind[b], sizeof(DMat)) == 0;
+
+	double secDat   = chrono::duration_cast<chrono::duration<double> >(t1 - t0).count();
+	double secBaked = chrono::duration_cast<chrono::duration<double> >(t2 - t1).count();
+
+	printf("Baked %s (%d bytes) -> %s (%d bytes): %s\n", fIn.c_str(), MMapFile(fIn).Size(), fOut.c_str(), sb->image.size(), same ? "identical" : "MISMATCH");
+	printf("Load: parse %.3f ms, baked %.3f ms\n", secDat * 1e3, secBaked * 1e3);
+}
+
+/* CLI: MeshWeld and MeshOptimize every mesh of 'fName', report vertex counts, index buffer sizes and vertex cache miss ratios */
+void BlendUtilRunOptMesh(const string &fName) {
+	shared_ptr<SectionDataEx> sd(BlendUtilMakeSectionDataEx(fName));
+	vector<MeshWeldResult> weld;
+	vector<MeshOptimizeResult> res;
+
+	chrono::high_resolution_clock::time_point t0 = chrono::high_resolution_clock::now();
+	MeshWeld(sd.get(), &weld);
+	MeshOptimize(sd.get(), &res);
+	chrono::high_resolution_clock::time_point t1 = chrono::high_resolution_clock::now();
+
+	double sec = chrono::duration_cast<chrono::duration<double> >(t1 - t0).count();
+
+	int numTri = 0, indexBytesBefore = 0, indexBytesAfter = 0;
+	double missBefore = 0.0, missAfter = 0.0;
+	for (int m = 0; m < res.size(); m++) {
+		vector<uint16_t> index16;
+		int numIndex = sd->meshIndex[m].size();
+		bool narrow = numIndex && MeshIndex16(sd->meshIndex[m].data(), numIndex, weld[m].numVertAfter, &index16);
+
+		printf("%s: %d tris, verts %d -> %d, %d bit indices, ACMR %.3f -> %.3f\n", sd->meshName[m].c_str(), res[m].numTri,
+			weld[m].numVertBefore, weld[m].numVertAfter, narrow ? 16 : 32, res[m].acmrBefore, res[m].acmrAfter);
+		numTri           += res[m].numTri;
+		missBefore       += res[m].acmrBefore * res[m].numTri;
+		missAfter        += res[m].acmrAfter * res[m].numTri;
+		indexBytesBefore += numIndex * 4;
+		indexBytesAfter  += numIndex * (narrow ? 2 : 4);
+	}
+
+	printf("Total %d tris, index %d -> %d bytes, ACMR %.3f -> %.3f (FIFO 16), %.3f ms\n", numTri, indexBytesBefore, indexBytesAfter,
+		numTri ? missBefore / numTri : 0.0, numTri ? missAfter / numTri : 0.0, sec * 1e3);
+}
+
+/* Microbenchmark of the MESHVERTBONEWEIGHT decode: mFillVertWeight against the sorting mFillVertWeightSort.
+*  Synthetic vertices with 0 to 2*BU_MAX_INFLUENCING_BONE influences each. */
+void BlendUtilBenchVertWeight(int numVert) {
+	string acc;
+	vector<pair<int, int> > begEnd;
+
+	srand(1);
+	for (int i = 0; i < numVert; i++) {
+		int numInflu = rand() % (2 * BU_MAX_INFLUENCING_BONE + 1);
+		int beg = acc.size();
+		for (int j = 0; j < numInflu; j++) {
+			int32_t id = rand() % BU_MAX_TOTAL_BONE_PER_MESH;
+			float   wt = (float)rand() / RAND_MAX;
+			acc.append((const char *)&id, 4);
+			acc.append((const char *)&wt, 4);
+		}
+		begEnd.push_back(make_pair(beg, (int)acc.size()));
+	}
+
+	Slice all(slice_str_t(), acc);
+	vector<Slice> chunk;
+	for (auto &i : begEnd)
+		chunk.push_back(Slice(slice_reslice_rel_t(), all, i.first, i.second));
+
+	vector<int>   oIdA(BU_MAX_INFLUENCING_BONE * numVert), oIdB(BU_MAX_INFLUENCING_BONE * numVert);
+	vector<float> oWtA(BU_MAX_INFLUENCING_BONE * numVert), oWtB(BU_MAX_INFLUENCING_BONE * numVert);
+
+	chrono::high_resolution_clock::time_point t0 = chrono::high_resolution_clock::now();
+	for (int i = 0; i < numVert; i++)
+		Parse::mFillVertWeightSort(chunk[i], &oIdA[BU_MAX_INFLUENCING_BONE * i], &oWtA[BU_MAX_INFLUENCING_BONE * i]);
+	chrono::high_resolution_clock::time_point t1 = chrono::high_resolution_clock::now();
+	Parse::mFillVertWeightBatch(&chunk[0], numVert, &oIdB[0], &oWtB[0]);
+	chrono::high_resolution_clock::time_point t2 = chrono::high_resolution_clock::now();
+
+	double sA = chrono::duration_cast<chrono::duration<double> >(t1 - t0).count();
+	double sB = chrono::duration_cast<chrono::duration<double> >(t2 - t1).count();
+
+	printf("VertWeight %d verts: sort %.0f vert/s, topk %.0f vert/s, %s\n",
+		numVert, numVert / sA, numVert / sB, (oIdA == oIdB && oWtA == oWtB) ? "weights match" : "WEIGHTS DIFFER");
+}
+
+/* Seconds for one call of 'fn': best of 'numRep' timed calls after an untimed warm-up call,
+*  so that page faults, cold caches and clock ramp-up land on the warm-up and not on whichever kernel runs first */
+template<typename F>
+double BenchSeconds(int numRep, const F &fn) {
+	fn();
+
+	double best = 0.0;
+	for (int r = 0; r < numRep; r++) {
+		chrono::high_resolution_clock::time_point t0 = chrono::high_resolution_clock::now();
+		fn();
+		chrono::high_resolution_clock::time_point t1 = chrono::high_resolution_clock::now();
+		double s = chrono::duration_cast<chrono::duration<double> >(t1 - t0).count();
+		best = r ? min(best, s) : s;
+	}
+
+	return best;
+}
+
+/* Kernel throughput in steady state: 'numMat' defaults small enough (See Main.cpp) for the operands to stay cache resident */
+void BlendUtilBenchMat(int numMat) {
+	const int numRep = 20;
+
+	vector<DMat> lhs(numMat), rhs(numMat), oA(numMat), oB(numMat);
+
+	srand(1);
+	for (int i = 0; i < numMat; i++)
+		for (int j = 0; j < 16; j++) {
+			lhs[i].d[j] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+			rhs[i].d[j] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+		}
+
+	const char *name;
+	DMatKernelSelect(&name);
+
+	double sA = BenchSeconds(numRep, [&]() { DMatMultiplyManyScalar(&lhs[0], &rhs[0], &oA[0], numMat); });
+	double sB = BenchSeconds(numRep, [&]() { DMat::MultiplyMany(&lhs[0], &rhs[0], &oB[0], numMat); });
+
+	/* Entries are sums of four products of values in [-1, 1]; FMA kernels may differ in the last bits */
+	float maxDiff = 0.0f;
+	bool transposeOk = true;
+	for (int i = 0; i < numMat; i++) {
+		DMat tA = DMat::TransposeScalar(lhs[i]);
+		DMat tB = DMat::Transpose(lhs[i]);
+		DMat mS = DMat::Multiply(lhs[i], rhs[i]);
+		for (int j = 0; j < 16; j++) {
+			maxDiff = max(maxDiff, std::fabsf(oA[i].d[j] - oB[i].d[j]));
+			maxDiff = max(maxDiff, std::fabsf(oA[i].d[j] - mS.d[j]));
+			transposeOk = transposeOk && tA.d[j] == tB.d[j];
+		}
+	}
+
+	printf("Mat %d multiplies: scalar %.0f mat/s, %s %.0f mat/s, max diff %g, %s\n",
+		numMat, numMat / sA, name, numMat / sB, maxDiff,
+		(maxDiff < 1e-5f && transposeOk) ? "results match" : "RESULTS DIFFER");
+
+	/* Invert against the scalar InvertEx. Affine inputs take InvertAffine, projective ones the general path
+	*  (InvertExSse2 where BU_DMAT_SSE2 is defined). */
+	auto benchInvert = [&](const char *what, const vector<DMat> &in) {
+		double sC = BenchSeconds(numRep, [&]() {
+			for (int i = 0; i < numMat; i++)
+				DMat::InvertEx(in[i], &oA[i]);
+		});
+		double sD = BenchSeconds(numRep, [&]() {
+			for (int i = 0; i < numMat; i++)
+				DMat::Invert(in[i], &oB[i]);
+		});
+
+		float maxInvDiff = 0.0f;
+		for (int i = 0; i < numMat; i++)
+			for (int j = 0; j < 16; j++)
+				maxInvDiff = max(maxInvDiff, std::fabsf(oA[i].d[j] - oB[i].d[j]));
+
+		printf("Mat %d %s inverses: general %.0f mat/s, auto %.0f mat/s, max diff %g, %s\n",
+			numMat, what, numMat / sC, numMat / sD, maxInvDiff, maxInvDiff < 1e-4f ? "results match" : "RESULTS DIFFER");
+	};
+
+	/* Strong diagonal keeps the random inputs well conditioned; the affine set also has its bottom row forced to 0 0 0 1 */
+	vector<DMat> projective(lhs), affine(lhs);
+	for (int i = 0; i < numMat; i++)
+		for (int j = 0; j < 4; j++) {
+			DMAT_ELT(projective[i], j, j) += 3.0f;
+			DMAT_ELT(affine[i], 3, j) = j == 3 ? 1.0f : 0.0f;
+			DMAT_ELT(affine[i], j, j) += 3.0f;
+		}
+
+	benchInvert("affine", affine);
+	benchInvert("projective", projective);
+}
+
+/* Each path is timed through BenchSeconds, so the vert/s figures compare with benchmat and benchanim */
+void BlendUtilBenchSkin(int numVert, int numThread) {
+	const int numBone = BU_MAX_TOTAL_BONE_PER_MESH;
+	const int numRep  = 20;
+
+	vector<float> vert(3 * numVert), oA(3 * numVert), oB(3 * numVert), oC(3 * numVert);
+	vector<int>   vertId(BU_MAX_INFLUENCING_BONE * numVert);
+	vector<float> vertWt(BU_MAX_INFLUENCING_BONE * numVert);
+	vector<DMat>  boneMat(numBone);
+
+	srand(1);
+	for (int b = 0; b < numBone; b++)
+		for (int j = 0; j < 16; j++)
+			boneMat[b].d[j] = (j % 4 == 3) ? (j == 15 ? 1.0f : 0.0f) : (float)rand() / RAND_MAX * 2.0f - 1.0f;
+	for (int i = 0; i < 3 * numVert; i++)
+		vert[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+	for (int v = 0; v < numVert; v++) {
+		/* Every eighth vertex unweighted, exercising the MeshMat fallback */
+		float sum = 0.0f;
+		for (int k = 0; k < BU_MAX_INFLUENCING_BONE; k++) {
+			vertId[BU_MAX_INFLUENCING_BONE * v + k] = rand() % numBone;
+			sum += (vertWt[BU_MAX_INFLUENCING_BONE * v + k] = (v % 8 == 7) ? 0.0f : (float)rand() / RAND_MAX);
+		}
+		for (int k = 0; k < BU_MAX_INFLUENCING_BONE && sum != 0.0f; k++)
+			vertWt[BU_MAX_INFLUENCING_BONE * v + k] /= sum;
+	}
+
+	DMat meshMat = boneMat[0];
+
+	const char *name;
+	SkinLbsKernelSelect(&name);
+	ThreadPool pool(numThread ? numThread : thread::hardware_concurrency());
+
+	double sA = BenchSeconds(numRep, [&]() { SkinLbsScalar(&vert[0], &vertId[0], &vertWt[0], 0, numVert, &boneMat[0], meshMat, &oA[0]); });
+	double sB = BenchSeconds(numRep, [&]() { SkinLbs(&vert[0], &vertId[0], &vertWt[0], numVert, &boneMat[0], meshMat, &oB[0]); });
+	double sC = BenchSeconds(numRep, [&]() { SkinLbs(&vert[0], &vertId[0], &vertWt[0], numVert, &boneMat[0], meshMat, &oC[0], &pool); });
+
+	float maxDiff = 0.0f;
+	for (int i = 0; i < 3 * numVert; i++) {
+		maxDiff = max(maxDiff, std::fabsf(oA[i] - oB[i]));
+		maxDiff = max(maxDiff, std::fabsf(oA[i] - oC[i]));
+	}
+
+	printf("Skin %d verts: scalar %.0f vert/s, %s %.0f vert/s, %s x%d threads %.0f vert/s, max diff %g, %s\n",
+		numVert, numVert / sA, name, numVert / sB, name, pool.NumThread(), numVert / sC, maxDiff,
+		maxDiff < 1e-4f ? "results match" : "RESULTS DIFFER");
+
+	/* Quantised streams, error against the float result */
+	{
+		MeshVertQ q;
+		MeshVertQ::Make(&vert[0], &vertId[0], &vertWt[0], numVert, MeshVertQ::PosUnorm16, MeshVertQ::WtUnorm8, &q);
+
+		double sQ = BenchSeconds(numRep, [&]() { SkinLbsQ(q, &boneMat[0], meshMat, &oB[0]); });
+
+		float maxQDiff = 0.0f;
+		for (int i = 0; i < 3 * numVert; i++)
+			maxQDiff = max(maxQDiff, std::fabsf(oA[i] - oB[i]));
+
+		printf("Skin %d verts: quantised (unorm16 pos, unorm8 wt) %.0f vert/s, %.1f bytes/vert (float %d), max diff %g\n",
+			numVert, numVert / sQ, (double)q.Bytes() / max(numVert, 1), (int)(3 * sizeof(float) + BU_MAX_INFLUENCING_BONE * (sizeof(int) + sizeof(float))), maxQDiff);
+	}
+
+	/* Dual quaternions over rigid bones (rotation from a random unit quaternion), checked per bone against the matrix */
+	for (int b = 0; b < numBone; b++) {
+		float q[4], len = 0.0f;
+		for (int j = 0; j < 4; j++) {
+			q[j] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+			len += q[j] * q[j];
+		}
+		len = sqrtf(len);
+		float x = q[0] / len, y = q[1] / len, z = q[2] / len, w = q[3] / len;
+		boneMat[b] = DMat::MakeFromVec(
+			1 - 2 * (y * y + z * z), 2 * (x * y - z * w), 2 * (x * z + y * w), (float)rand() / RAND_MAX,
+			2 * (x * y + z * w), 1 - 2 * (x * x + z * z), 2 * (y * z - x * w), (float)rand() / RAND_MAX,
+			2 * (x * z - y * w), 2 * (y * z + x * w), 1 - 2 * (x * x + y * y), (float)rand() / RAND_MAX,
+			0, 0, 0, 1);
+	}
+
+	vector<DDualQuat> boneDQ(numBone);
+	DDualQuat::MakeFromMatMany(&boneMat[0], &boneDQ[0], numBone);
+
+	float maxDQDiff = 0.0f;
+	for (int b = 0; b < numBone; b++)
+		for (int v = 0; v < min(numVert, 64); v++) {
+			float oM[3], oQ[3];
+			int   id[BU_MAX_INFLUENCING_BONE] = { b };
+			float wt[BU_MAX_INFLUENCING_BONE] = { 1.0f };
+			SkinLbsOne(&vert[3 * v], id, wt, &boneMat[0], meshMat, oM);
+			SkinDqsOne(&vert[3 * v], id, wt, &boneDQ[0], meshMat, oQ);
+			for (int j = 0; j < 3; j++)
+				maxDQDiff = max(maxDQDiff, std::fabsf(oM[j] - oQ[j]));
+		}
+
+	double sD = BenchSeconds(numRep, [&]() { SkinDqs(&vert[0], &vertId[0], &vertWt[0], numVert, &boneDQ[0], meshMat, &oA[0]); });
+
+	printf("Skin %d verts: dqs %.0f vert/s, single-bone max diff to lbs %g, %s\n",
+		numVert, numVert / sD, maxDQDiff, maxDQDiff < 1e-4f ? "results match" : "RESULTS DIFFER");
+}
+
+/* Max component difference; quaternions (dim 4) compare up to sign */
+float AnimKeyErr(const float *a, const float *b, int dim) {
+	float e = 0.0f, eNeg = 0.0f;
+	for (int i = 0; i < dim; i++) {
+		e    = max(e, std::fabsf(a[i] - b[i]));
+		eNeg = max(eNeg, std::fabsf(a[i] + b[i]));
+	}
+	return dim == 4 ? min(e, eNeg) : e;
+}
+
+/* Keys kept by greedy linear reduction: each segment is extended while every key it skips stays within 'tol' of the
+*  interpolation (lerp, nlerp for dim 4) between its ends. Same as BlendGen.py animReduceLinear. */
+void AnimReduceLinear(const float *time, const float *val, int dim, int n, float tol, vector<int> *oKeep) {
+	oKeep->assign(1, 0);
+
+	for (int beg = 0, end; beg < n - 1; beg = end) {
+		for (end = beg + 1; end + 1 < n; end++) {
+			int cand = end + 1;
+			bool ok = true;
+			for (int i = beg + 1; i < cand && ok; i++) {
+				float f = (time[i] - time[beg]) / (time[cand] - time[beg]);
+				float v[4];
+				if (dim == 4)
+					QuatNlerp(&val[4 * beg], &val[4 * cand], f, v);
+				else
+					for (int j = 0; j < dim; j++)
+						v[j] = val[dim * beg + j] + (val[dim * cand + j] - val[dim * beg + j]) * f;
+				ok = AnimKeyErr(v, &val[dim * i], dim) <= tol;
+			}
+			if (!ok)
+				break;
+		}
+		oKeep->push_back(end);
+	}
+}
+
+/* One ANIMCHANPACK channel (See Parse::FillAnimChanPack) from 'numKey' keys at ascending 'time', with tol[AnimTrackCount]
+*  bounding each track's error at the input keys. Same output as BlendGen.py mkAnimChanPack (up to float rounding),
+*  kept for BlendUtilBenchAnim to round-trip the decoder. */
+void AnimChanPack(const float *time, const DTrs *key, int numKey, const float *tol, string *oChunk) {
+	static const float ident[AnimTrackCount][4] = { { 0.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f, 0.0f } };
+	vector<float> val;
+	vector<int>   keep;
+
+	oChunk->clear();
+
+	for (int j = 0; j < AnimTrackCount; j++) {
+		int dim = j == AnimRot ? 4 : 3;
+
+		val.resize(dim * numKey);
+		for (int k = 0; k < numKey; k++) {
+			const float *v = j == AnimLoc ? key[k].t : j == AnimRot ? key[k].r : key[k].s;
+			float *d = &val[dim * k];
+			memcpy(d, v, dim * sizeof(float));
+			/* Hemisphere continuity, so that neighbouring keys interpolate the short way */
+			if (j == AnimRot && k && d[0] * d[-4] + d[1] * d[-3] + d[2] * d[-2] + d[3] * d[-1] < 0.0f)
+				for (int i = 0; i < 4; i++)
+					d[i] = -d[i];
+		}
+
+		bool isDefault = true, isConst = true;
+		for (int k = 0; k < numKey; k++) {
+			isDefault = isDefault && AnimKeyErr(&val[dim * k], ident[j], dim) <= tol[j];
+			isConst   = isConst && AnimKeyErr(&val[dim * k], &val[0], dim) <= tol[j];
+		}
+
+		if (isDefault)
+			keep.clear();
+		else if (isConst)
+			keep.assign(1, 0);
+		else
+			AnimReduceLinear(time, &val[0], dim, numKey, tol[j], &keep);
+
+		int32_t numKept = keep.size();
+		oChunk->append((const char *)&numKept, 4);
+		if (numKept > 1)
+			for (auto &k : keep)
+				oChunk->append((const char *)&time[k], 4);
+		for (auto &k : keep) {
+			if (j == AnimRot) {
+				uint16_t q[3];
+				QuatSmallest3Encode(&val[4 * k], q);
+				for (int i = 0; i < 3; i++) {
+					oChunk->push_back((char)(q[i] & 0xFF));
+					oChunk->push_back((char)(q[i] >> 8));
+				}
+			} else {
+				oChunk->append((const char *)&val[3 * k], 3 * sizeof(float));
+			}
+		}
+	}
+}
+
+void BlendUtilBenchPose(int numChar, int numThread) {
+	const int numBone = BU_MAX_TOTAL_BONE_PER_MESH;
+	const int numClip = 4;
+	const int numKey  = 30;
+	const int numFrame = 10;
+
+	/* Binary-tree skeleton with every bone keyed in every clip */
+	SectionDataHier sd;
+	srand(1);
+	for (int b = 0; b < numBone; b++) {
+		sd.boneName.push_back("Bone");
+		sd.boneParent.push_back(b == 0 ? -1 : (b - 1) / 2);
+		DTrs rest = DTrs::MakeIdentity();
+		rest.t[1] = 1.0f;
+		sd.boneMatrix.push_back(rest.ToMat());
+	}
+	Parse::FillBoneInvBind(sd.boneMatrix, &sd.boneInvBind);
+	Parse::FillChild(sd.boneParent, &sd.boneChild);
+	HierarchyValidate(sd.boneParent, sd.boneChild, &sd.boneTopo);
+	Parse::FillBoneRestLocal(&sd);
+
+	vector<float> time(numKey);
+	vector<DTrs>  key(numKey);
+	for (int k = 0; k < numKey; k++)
+		time[k] = (float)k / (numKey - 1);
+
+	for (int c = 0; c < numClip; c++) {
+		AnimClip clip;
+		clip.duration = 1.0f;
+		for (int b = 0; b < numBone; b++) {
+			for (int k = 0; k < numKey; k++) {
+				key[k] = DTrs::MakeIdentity();
+				float len = 0.0f;
+				for (int j = 0; j < 4; j++) {
+					key[k].r[j] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+					len += key[k].r[j] * key[k].r[j];
+				}
+				for (int j = 0; j < 4; j++)
+					key[k].r[j] /= sqrtf(len);
+				key[k].t[0] = (float)rand() / RAND_MAX;
+			}
+			AnimClipAddChannel(&clip, b, &time[0], &key[0], numKey);
+		}
+		sd.anim.push_back(clip);
+	}
+
+	/* Locomotion blend, upper body (second half of the bones) overridden by an aim clip, breathing layered on top */
+	PoseBlendTree tree;
+	vector<float> upper(numBone, 0.0f);
+	fill(upper.begin() + numBone / 2, upper.end(), 1.0f);
+	int walk = tree.AddClip(0);
+	int run  = tree.AddClip(1);
+	int loco = tree.AddBlend(walk, run);
+	int aim  = tree.AddClip(2);
+	int body = tree.AddBlend(loco, aim, tree.AddMask(upper));
+	int brth = tree.AddClip(3);
+	int root = tree.AddAdditive(body, brth);
+
+	vector<PoseBlendInstance> inst;
+	for (int i = 0; i < numChar; i++) {
+		PoseBlendInstance pbi(tree, sd);
+		pbi.weight[loco] = (float)rand() / RAND_MAX;
+		pbi.weight[body] = 1.0f;
+		pbi.weight[root] = 0.5f;
+		inst.push_back(pbi);
+	}
+
+	vector<DTrs> pose(numChar * numBone);
+	vector<DMat> world(numChar * numBone);
+	vector<PosePool> posePool;
+	ThreadPool pool(numThread ? numThread : thread::hardware_concurrency());
+
+	chrono::high_resolution_clock::time_point t0 = chrono::high_resolution_clock::now();
+	for (int f = 0; f < numFrame; f++) {
+		for (int i = 0; i < numChar; i++)
+			for (int n = 0; n < tree.node.size(); n++)
+				inst[i].time[n] = (f + (float)i / numChar) / numFrame;
+		PoseBlendUpdate(&inst[0], numChar, sd, &posePool, &pose[0], &world[0], &pool);
+	}
+	chrono::high_resolution_clock::time_point t1 = chrono::high_resolution_clock::now();
+
+	double ms = chrono::duration_cast<chrono::duration<double> >(t1 - t0).count() * 1000.0;
+
+	bool poolOk = true;
+	for (auto &i : posePool)
+		poolOk = poolOk && i.NumFree() == tree.NumBuffer();
+
+	printf("Pose %d characters x %d bones, %d frames, %d threads: %.1f characters/ms, %s\n",
+		numChar, numBone, numFrame, pool.NumThread(), numChar * numFrame / ms, poolOk ? "pool balanced" : "POOL LEAKED");
+}
+
+/* Round trip of the ANIMCHANPACK decoder: a synthetic clip keyed at every frame is packed by AnimChanPack with the
+*  BlendGen.py default tolerances, loaded by Parse::FillAnimChanPack and sampled between the frames against interpolation
+*  of the input keys. Memory is compared against the DTrs keys per frame that the clip used to be expanded to.
+*  Bones mimic a character rig: a moving root, a quarter of the bones swinging at walk cadence (limbs), a quarter
+*  swaying slowly (spine), the rest holding a fixed pose (fingers, face); every eighth bone also pulses in scale. */
+void BlendUtilBenchAnim(int numBone, int numFrame) {
+	const float fps = 30.0f;
+	const float tol[AnimTrackCount] = { 0.0001f, 0.001f, 0.0001f };
+	const int   numSub = 4;
+	const int   numRep = 20;
+	const float twoPi = 6.2831853f;
+
+	assert(numBone >= 1 && numFrame >= 2);
+
+	vector<float> time(numFrame);
+	vector<DTrs>  key(numBone * numFrame);
+	for (int k = 0; k < numFrame; k++)
+		time[k] = k / fps;
+	for (int b = 0; b < numBone; b++) {
+		float phase = b * 0.37f;
+		float axis[3] = { sinf(phase), cosf(phase), 0.5f };
+		float axisLen = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+		for (int k = 0; k < numFrame; k++) {
+			DTrs &o = key[b * numFrame + k] = DTrs::MakeIdentity();
+			float x = time[k];
+			if (b == 0) {
+				o.t[0] = 0.2f * sinf(twoPi * 0.5f * x);
+				o.t[1] = 0.1f * sinf(twoPi * x);
+			}
+			float half = b % 4 == 0 ? 0.3f * sinf(twoPi * 1.0f * x + phase) :
+				b % 4 == 1 ? 0.1f * sinf(twoPi * 0.25f * x + phase) : 0.2f;
+			for (int j = 0; j < 3; j++)
+				o.r[j] = sinf(half) * axis[j] / axisLen;
+			o.r[3] = cosf(half);
+			if (b % 8 == 7)
+				o.s[0] = o.s[1] = o.s[2] = 1.0f + 0.05f * sinf(twoPi * 2.0f * x);
+		}
+	}
+
+	AnimClip raw, packed;
+	raw.duration = packed.duration = 0.0f;
+	string chunk;
+	int fileBytes = 0;
+	for (int b = 0; b < numBone; b++) {
+		AnimClipAddChannel(&raw, b, &time[0], &key[b * numFrame], numFrame);
+		AnimChanPack(&time[0], &key[b * numFrame], numFrame, tol, &chunk);
+		fileBytes += chunk.size();
+		Parse::FillAnimChanPack(Slice(slice_str_t(), chunk), b, &packed);
+	}
+
+	int numSample = (numFrame - 1) * numSub + 1;
+	vector<DTrs> pose(numBone);
+	float err[AnimTrackCount] = { 0.0f, 0.0f, 0.0f };
+	AnimSampler sampler(packed);
+	for (int i = 0; i < numSample; i++) {
+		float t = i / (numSub * fps);
+		int   k = min(i / numSub, numFrame - 2);
+		float f = (t - time[k]) / (time[k + 1] - time[k]);
+		sampler.Sample(t, numBone, &pose[0]);
+		for (int b = 0; b < numBone; b++) {
+			const DTrs &a = key[b * numFrame + k];
+			const DTrs &c = key[b * numFrame + k + 1];
+			DTrs ref;
+			Vec4Lerp(a.t, c.t, f, ref.t);
+			QuatNlerp(a.r, c.r, f, ref.r);
+			Vec4Lerp(a.s, c.s, f, ref.s);
+			err[AnimLoc]   = max(err[AnimLoc], AnimKeyErr(pose[b].t, ref.t, 3));
+			err[AnimRot]   = max(err[AnimRot], AnimKeyErr(pose[b].r, ref.r, 4));
+			err[AnimScale] = max(err[AnimScale], AnimKeyErr(pose[b].s, ref.s, 3));
+		}
+	}
+
+	/* Rotations also carry the smallest-three quantization, 15 bits over [-1/sqrt(2), 1/sqrt(2)] per component */
+	bool errOk = err[AnimLoc] <= tol[AnimLoc] + 1e-6f && err[AnimRot] <= tol[AnimRot] + 2e-4f && err[AnimScale] <= tol[AnimScale] + 1e-6f;
+
+	auto sampleAll = [&](const AnimClip &clip) {
+		AnimSampler s(clip);
+		for (int i = 0; i < numSample; i++)
+			s.Sample(i / (numSub * fps), numBone, &pose[0]);
+	};
+	double sRaw    = BenchSeconds(numRep, [&]() { sampleAll(raw); });
+	double sPacked = BenchSeconds(numRep, [&]() { sampleAll(packed); });
+
+	int keyBytes = numBone * numFrame * (sizeof(float) + sizeof(DTrs));
+	printf("Anim %d bones x %d frames: DTrs keys %d bytes, file %d bytes, packed clip %d bytes (%.1fx smaller)\n",
+		numBone, numFrame, keyBytes, fileBytes, (int)packed.KeyBytes(), (double)keyBytes / packed.KeyBytes());
+	printf("Anim max error loc %g rot %g scale %g, %s; sample unreduced %.0f poses/s, packed %.0f poses/s\n",
+		err[AnimLoc], err[AnimRot], err[AnimScale], errOk ? "within tolerance" : "EXCEEDS TOLERANCE",
+		numSample / sRaw, numSample / sPacked);
+}
+
 void BlendUtilRun(void) {
 	SectionDataEx *sd = BlendUtilMakeSectionDataEx("../tmpdata.dat");
 }
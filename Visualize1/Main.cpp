@@ -28,6 +28,9 @@
 #define G_MAX_BONES_UNIFORM     30
 #define G_MAX_BONES_INFLUENCING 4
 
+/* Draw from quantised vertex streams (MeshVertQ, vsBoneQ) instead of the float ones */
+#define G_VERT_QUANT 1
+
 #define EX_OGLPLUS_ERROR_WRAP_START()                      \
 	try {
 #define EX_OGLPLUS_ERROR_WRAP_MIDDLE()                     \
@@ -82,23 +85,8 @@ namespace Cruft {
 	}
 
 	string ReadFile(const string &fname) {
-		int r;
-		char buf[1024];
-		string acc;
-		FILE *f;
-
-		f = fopen(fname.c_str(), "rb");
-		assert(f);
-
-		while ((r = fread(buf, 1, 1024, f)))
-			acc.append(buf, r);
-
-		assert(!ferror(f));
-		assert(feof(f));
-
-		fclose(f);
-
-		return acc;
+		MMapFile m(fname);
+		return string(m.Data(), m.Size());
 	}
 
 	map<string, string> ParseShdFromString(const string &acc) {
@@ -292,7 +280,8 @@ namespace Md {
 		MdT(const Mat4f &p, const Mat4f &c, const Mat4f &m) : ProjectionMatrix(p), CameraMatrix(c), ModelMatrix(m) {}
 	};
 
-	Program * ProgramFromShaderMap(const map<string, string> &mapShdString, const string &root) {
+	/* Links vs<root> with fs<fsRoot>, fs<root> if fsRoot is empty */
+	Program * ProgramFromShaderMap(const map<string, string> &mapShdString, const string &root, const string &fsRoot = string()) {
 		VertexShader vs;
 		FragmentShader fs;
 		Program *prog = new Program();
@@ -304,7 +293,7 @@ namespace Md {
 		string vsSrc(defS);
 		vsSrc.append(mapShdString.at(string("vs").append(root)));
 		string fsSrc(defS);
-		fsSrc.append(mapShdString.at(string("fs").append(root)));
+		fsSrc.append(mapShdString.at(string("fs").append(fsRoot.empty() ? root : fsRoot)));
 
 		vs.Source(vsSrc);
 		fs.Source(fsSrc);
@@ -321,6 +310,14 @@ namespace Md {
 		return ProgramFromShaderMap(gShdString, "Bone");
 	}
 
+	Program * ShaderTexSimpleDQ() {
+		return ProgramFromShaderMap(gShdString, "BoneDQ", "Bone");
+	}
+
+	Program * ShaderTexSimpleQ() {
+		return ProgramFromShaderMap(gShdString, "BoneQ", "Bone");
+	}
+
 	class ShdTexSimple : public Shd {
 	public:
 
@@ -330,25 +327,47 @@ namespace Md {
 
 			shared_ptr<Buffer> id;
 			shared_ptr<Buffer> vt;
+			/* UnsignedShort for meshes of fewer than 65536 vertices (See MeshIndex16), UnsignedInt otherwise */
+			oglplus::DataType indexType;
 
 			shared_ptr<Buffer> meshVertId;
 			shared_ptr<Buffer> meshVertWt;
 
 			vector<DMat> boneMeshToBoneMatrix;
 
+			/* Quantised streams (vsBoneQ): attribute types and the scales that undo the quantisation */
+			bool quant;
+			oglplus::DataType posType, wtType;
+			GLint posComp;
+			float posMin[3], posScale[3], wtScale;
+
+			void UploadIndex(const int *index, int numIndex, int numVert) {
+				vector<uint16_t> index16;
+
+				id->Bind(oglplus::BufferOps::Target::Array);
+				if (MeshIndex16(index, numIndex, numVert, &index16)) {
+					Buffer::Data(oglplus::BufferOps::Target::Array, index16);
+					indexType = oglplus::DataType::UnsignedShort;
+				} else {
+					assert(sizeof(GLuint) == sizeof(int));
+					Buffer::Data(oglplus::BufferOps::Target::Array, numIndex, (const GLuint *)index);
+					indexType = oglplus::DataType::UnsignedInt;
+				}
+			}
+
 			MdD(const SectionDataEx &sde, int meshId, const vector<DMat> &mtbm) :
 				triCnt(sde.meshIndex[meshId].size() / 3),
 				id(new Buffer()),
 				vt(new Buffer()),
 				meshVertId(new Buffer()),
-				meshVertWt(new Buffer())
+				meshVertWt(new Buffer()),
+				quant(false)
 			{
 				assert(sde.meshIndex[meshId].size() % 3 == 0);
 
 				/* Mesh */
 
-				id->Bind(oglplus::BufferOps::Target::Array);
-				Buffer::Data(oglplus::BufferOps::Target::Array, ExIntToGLuint(sde.meshIndex[meshId]));
+				UploadIndex(sde.meshIndex[meshId].data(), sde.meshIndex[meshId].size(), sde.meshVert[meshId].size() / 3);
 
 				vt->Bind(oglplus::BufferOps::Target::Array);
 				Buffer::Data(oglplus::BufferOps::Target::Array, ExFloatToGLfloat(sde.meshVert[meshId]));
@@ -363,22 +382,116 @@ namespace Md {
 
 				boneMeshToBoneMatrix = mtbm;
 			}
+
+			/* Packed attributes are uploaded straight from the contiguous arrays, no conversion copies */
+			MdD(const SectionDataPacked &sdp, int meshId, const vector<DMat> &mtbm) :
+				triCnt(sdp.meshIndex.Count(meshId) / 3),
+				id(new Buffer()),
+				vt(new Buffer()),
+				meshVertId(new Buffer()),
+				meshVertWt(new Buffer()),
+				quant(false)
+			{
+				assert(sdp.meshIndex.Count(meshId) % 3 == 0);
+				assert(sizeof(GLuint) == sizeof(int) && sizeof(GLfloat) == sizeof(float));
+
+				/* Mesh */
+
+				UploadIndex(sdp.meshIndex.Ptr(meshId), sdp.meshIndex.Count(meshId), sdp.meshVert.Count(meshId) / 3);
+
+				vt->Bind(oglplus::BufferOps::Target::Array);
+				Buffer::Data(oglplus::BufferOps::Target::Array, sdp.meshVert.Count(meshId), (const GLfloat *)sdp.meshVert.Ptr(meshId));
+
+				/* Bone */
+
+				meshVertId->Bind(oglplus::BufferOps::Target::Array);
+				Buffer::Data(oglplus::BufferOps::Target::Array, sdp.meshVertId.Count(meshId), (const GLuint *)sdp.meshVertId.Ptr(meshId));
+
+				meshVertWt->Bind(oglplus::BufferOps::Target::Array);
+				Buffer::Data(oglplus::BufferOps::Target::Array, sdp.meshVertWt.Count(meshId), (const GLfloat *)sdp.meshVertWt.Ptr(meshId));
+
+				boneMeshToBoneMatrix = mtbm;
+			}
+
+			/* Indices from sdp, vertex attributes from the quantised streams of the same mesh */
+			MdD(const SectionDataPacked &sdp, int meshId, const MeshVertQ &q, const vector<DMat> &mtbm) :
+				triCnt(sdp.meshIndex.Count(meshId) / 3),
+				id(new Buffer()),
+				vt(new Buffer()),
+				meshVertId(new Buffer()),
+				meshVertWt(new Buffer()),
+				quant(true)
+			{
+				assert(sdp.meshIndex.Count(meshId) % 3 == 0);
+				assert(q.numVert * 3 == sdp.meshVert.Count(meshId));
+
+				/* Mesh */
+
+				UploadIndex(sdp.meshIndex.Ptr(meshId), sdp.meshIndex.Count(meshId), sdp.meshVert.Count(meshId) / 3);
+
+				vt->Bind(oglplus::BufferOps::Target::Array);
+				if (q.posFormat == MeshVertQ::PosFloat) {
+					Buffer::Data(oglplus::BufferOps::Target::Array, q.posF);
+					posType = oglplus::DataType::Float;
+					posComp = 3;
+				} else {
+					Buffer::Data(oglplus::BufferOps::Target::Array, q.posQ);
+					posType = q.posFormat == MeshVertQ::PosHalf ? oglplus::DataType::HalfFloat : oglplus::DataType::UnsignedShort;
+					posComp = 4;
+				}
+				for (int j = 0; j < 3; j++) {
+					posMin[j]   = q.posMin[j];
+					posScale[j] = q.posScale[j];
+				}
+
+				/* Bone */
+
+				meshVertId->Bind(oglplus::BufferOps::Target::Array);
+				Buffer::Data(oglplus::BufferOps::Target::Array, q.id);
+
+				meshVertWt->Bind(oglplus::BufferOps::Target::Array);
+				if (q.wtFormat == MeshVertQ::WtUnorm8) {
+					Buffer::Data(oglplus::BufferOps::Target::Array, q.wt8);
+					wtType  = oglplus::DataType::UnsignedByte;
+					wtScale = 1.0f / 255.0f;
+				} else {
+					Buffer::Data(oglplus::BufferOps::Target::Array, q.wt16);
+					wtType  = oglplus::DataType::UnsignedShort;
+					wtScale = 1.0f / 65535.0f;
+				}
+
+				boneMeshToBoneMatrix = mtbm;
+			}
 		};
 
 		shared_ptr<Program> prog;
 		shared_ptr<VertexArray> va;
 
 		size_t triCnt;
+		oglplus::DataType indexType;
+
+		/* Dual quaternion skinning (vsBoneDQ, 8 floats per bone) instead of linear blend (vsBone, 16) */
+		bool dq;
+		/* Linear blend from quantised streams (vsBoneQ), MdD built from a MeshVertQ */
+		bool quant;
 
-		ShdTexSimple() :
-			prog(shared_ptr<Program>(ShaderTexSimple())),
+		ShdTexSimple(bool dq = false, bool quant = false) :
+			prog(shared_ptr<Program>(dq ? ShaderTexSimpleDQ() : quant ? ShaderTexSimpleQ() : ShaderTexSimple())),
 			va(new VertexArray()),
-			triCnt(0) {}
+			triCnt(0),
+			indexType(oglplus::DataType::UnsignedInt),
+			dq(dq),
+			quant(quant)
+		{
+			assert(!(dq && quant));
+		}
 
 		void Prime(const MdT &mt, const MdD &md, const DMat &meshMat, const vector<DMat> &boneWorldMatrix) {
 			assert(boneWorldMatrix.size() == md.boneMeshToBoneMatrix.size());
+			assert(md.quant == quant);
 
 			triCnt = md.triCnt;
+			indexType = md.indexType;
 
 			va->Bind();
 
@@ -387,13 +500,29 @@ namespace Md {
 			md.id->Bind(oglplus::BufferOps::Target::ElementArray);
 
 			md.vt->Bind(oglplus::BufferOps::Target::Array);
-			(*prog|"Position").Setup(3, oglplus::DataType::Float).Enable();
+			if (quant) {
+				(*prog|"PositionQ").Setup(md.posComp, md.posType).Enable();
+				ProgramUniform<Vec3f>(*prog, "PosMin") = Vec3f(md.posMin[0], md.posMin[1], md.posMin[2]);
+				ProgramUniform<Vec3f>(*prog, "PosScale") = Vec3f(md.posScale[0], md.posScale[1], md.posScale[2]);
+			} else {
+				(*prog|"Position").Setup(3, oglplus::DataType::Float).Enable();
+			}
 
 			/* Bone */
 
-			EX_OGLPLUS_ATTRIB_ARRAY_ACTIVE(*prog, "BoneId", md.meshVertId, 4, UnsignedInt);
+			if (quant) {
+				EX_OGLPLUS_ATTRIB_ARRAY_ACTIVE(*prog, "BoneId", md.meshVertId, 4, UnsignedByte);
 
-			EX_OGLPLUS_ATTRIB_ARRAY_ACTIVE(*prog, "BoneWt", md.meshVertWt, 4, Float);
+				if (IsAttribActive(*prog, "BoneWtQ")) {
+					md.meshVertWt->Bind(oglplus::BufferOps::Target::Array);
+					VertexAttribArray(*prog, "BoneWtQ").Setup(4, md.wtType).Enable();
+				}
+				OptionalProgramUniform<GLfloat>(*prog, "WtScale") = md.wtScale;
+			} else {
+				EX_OGLPLUS_ATTRIB_ARRAY_ACTIVE(*prog, "BoneId", md.meshVertId, 4, UnsignedInt);
+
+				EX_OGLPLUS_ATTRIB_ARRAY_ACTIVE(*prog, "BoneWt", md.meshVertWt, 4, Float);
+			}
 
 			/* MdT */
 
@@ -406,9 +535,24 @@ namespace Md {
 			{
 				vector<oglplus::Mat4f> v;
 				assert(boneWorldMatrix.size() == md.boneMeshToBoneMatrix.size());
-				for (int i = 0; i < boneWorldMatrix.size(); i++)
-					v.push_back(DMatToOgl(DMat::Multiply(boneWorldMatrix[i], md.boneMeshToBoneMatrix[i])));
-				OptionalProgramUniform<Mat4f>(*prog, "BoneMat").Set(v);
+				vector<DMat> boneMat(boneWorldMatrix.size());
+				if (boneMat.size())
+					DMat::MultiplyMany(&boneWorldMatrix[0], &md.boneMeshToBoneMatrix[0], &boneMat[0], boneMat.size());
+				if (dq) {
+					vector<DDualQuat> boneDQ(boneMat.size());
+					if (boneDQ.size())
+						DDualQuat::MakeFromMatMany(&boneMat[0], &boneDQ[0], boneDQ.size());
+					vector<oglplus::Vec4f> vDQ;
+					for (int i = 0; i < boneDQ.size(); i++) {
+						vDQ.push_back(oglplus::Vec4f(boneDQ[i].r[0], boneDQ[i].r[1], boneDQ[i].r[2], boneDQ[i].r[3]));
+						vDQ.push_back(oglplus::Vec4f(boneDQ[i].d[0], boneDQ[i].d[1], boneDQ[i].d[2], boneDQ[i].d[3]));
+					}
+					OptionalProgramUniform<Vec4f>(*prog, "BoneDQ").Set(vDQ);
+				} else {
+					for (int i = 0; i < boneMat.size(); i++)
+						v.push_back(DMatToOgl(boneMat[i]));
+					OptionalProgramUniform<Mat4f>(*prog, "BoneMat").Set(v);
+				}
 			}
 
 			Validate();
@@ -418,7 +562,7 @@ namespace Md {
 			assert(IsValid());
 
 			prog->Use();
-			Ctx::DrawElements(PrimitiveType::Triangles, triCnt * 3, oglplus::DataType::UnsignedInt);
+			Ctx::DrawElements(PrimitiveType::Triangles, triCnt * 3, indexType);
 			prog->UseNone();
 		}
 
@@ -434,18 +578,35 @@ namespace Md {
 
 	struct Ex1 : public ExBase {
 		Md::ShdTexSimple shd;
-		shared_ptr<SectionDataEx> sde;
+		shared_ptr<SectionDataPacked> sde;
 		shared_ptr<Md::MdT> mdt0, mdt1;
 		vector<shared_ptr<Md::ShdTexSimple::MdD> > mdd;
+		shared_ptr<AnimSampler> sampler;
+		vector<DTrs> pose;
+
+		Ex1() : shd(false, G_VERT_QUANT != 0) {
+			sde = shared_ptr<SectionDataPacked>(BlendUtilMakeSectionDataPacked("../tmpdata.dat"));
 
-		Ex1() {
-			sde = shared_ptr<SectionDataEx>(BlendUtilMakeSectionDataEx("../tmpdata.dat"));
+			int numBone = sde->boneName.size();
+			vector<DMat> meshBoneMeshToBoneMatrix;
+			MatrixMeshToBone(sde->meshMatrix, sde->boneInvBind, &meshBoneMeshToBoneMatrix);
 
-			vector<vector<DMat>> meshBoneMeshToBoneMatrix(sde->boneName.size());
-			MatrixMeshToBone(sde->meshMatrix, sde->boneMatrix, &meshBoneMeshToBoneMatrix);
+			vector<MeshVertQ> vertQ;
+			if (G_VERT_QUANT)
+				MakeMeshVertQ(*sde, MeshVertQ::PosUnorm16, MeshVertQ::WtUnorm8, &vertQ);
+
+			for (int i = 0; i < sde->meshName.size(); i++) {
+				vector<DMat> mtbm(meshBoneMeshToBoneMatrix.begin() + i * numBone, meshBoneMeshToBoneMatrix.begin() + (i + 1) * numBone);
+				if (G_VERT_QUANT)
+					mdd.push_back(shared_ptr<ShdTexSimple::MdD>(new ShdTexSimple::MdD(*sde, i, vertQ[i], mtbm)));
+				else
+					mdd.push_back(shared_ptr<ShdTexSimple::MdD>(new ShdTexSimple::MdD(*sde, i, mtbm)));
+			}
 
-			for (int i = 0; i < sde->meshName.size(); i++)
-				mdd.push_back(shared_ptr<ShdTexSimple::MdD>(new ShdTexSimple::MdD(*sde, i, meshBoneMeshToBoneMatrix[i])));
+			if (sde->anim.size()) {
+				sampler = shared_ptr<AnimSampler>(new AnimSampler(sde->anim[0]));
+				pose.resize(numBone);
+			}
 		}
 
 		void Display() {
@@ -454,6 +615,14 @@ namespace Md {
 			vector<DMat> meshWorldMatrix = sde->meshMatrix;
 			vector<DMat> boneWorldMatrix = sde->boneMatrix;
 
+			/* First clip looping at 60 ticks per second */
+			if (sampler) {
+				const AnimClip &clip = sde->anim[0];
+				float t = clip.duration > 0.0f ? fmodf(tick / 60.0f, clip.duration) : 0.0f;
+				sampler->Sample(t, pose.size(), &pose[0]);
+				AnimPoseToWorld(*sde, &pose[0], &boneWorldMatrix[0]);
+			}
+
 			/* Transform equal to BoneZero in blendOneBone.blend at the current time
 			ModelMatrixf mm;
 			mm = Multiplied(ModelMatrixf::RotationX(Degrees(90)), mm);